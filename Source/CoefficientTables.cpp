@@ -0,0 +1,113 @@
+#include "CoefficientTables.h"
+#include "FilterCascade.h"
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <array>
+#include <cmath>
+
+CoefficientTables::CoefficientTables(double sampleRateToUse) :
+sampleRate(sampleRateToUse),
+maxFrequency(float(sampleRateToUse * 0.4999))
+{
+    trigTerms.resize(numFrequencyPoints);
+    for (int i = 0; i < numFrequencyPoints; ++i)
+        trigTerms[(size_t) i] = computeTrigTerms(getFrequencyForIndex(i), sampleRate);
+
+    const auto numGainPoints = int((maxGainInDecibels - minGainInDecibels) * gainPointsPerDecibel) + 1;
+    peakGainFactors.resize((size_t) numGainPoints);
+    for (int i = 0; i < numGainPoints; ++i)
+        peakGainFactors[(size_t) i] = computePeakGainFactor(minGainInDecibels + float(i) / gainPointsPerDecibel);
+}
+
+std::shared_ptr<const CoefficientTables> CoefficientTables::getFor(double sampleRate)
+{
+    static juce::CriticalSection lock;
+    static std::vector<std::weak_ptr<const CoefficientTables>> cache;
+
+    const juce::ScopedLock sl(lock);
+
+    for (auto it = cache.begin(); it != cache.end();)
+    {
+        if (auto tables = it->lock())
+        {
+            if (tables->getSampleRate() == sampleRate)
+                return tables;
+
+            ++it;
+        }
+        else
+        {
+            it = cache.erase(it);
+        }
+    }
+
+    auto tables = std::make_shared<const CoefficientTables>(sampleRate);
+    cache.push_back(tables);
+    return tables;
+}
+
+double CoefficientTables::getFrequencyForIndex(int index)
+{
+    // point j of octave e sits at 2^(e-1) * (1 + j / pointsPerOctave)
+    const auto octave = index / pointsPerOctave;
+    const auto step = index % pointsPerOctave;
+    return std::ldexp(1.0 + double(step) / pointsPerOctave, minExponent + octave - 1);
+}
+
+CoefficientTables::TrigTerms CoefficientTables::getTrigTerms(float frequency) const
+{
+    int exponent = 0;
+    const auto mantissa = std::frexp(juce::jlimit(std::ldexp(0.5f, minExponent), maxFrequency, frequency), &exponent);
+
+    // frexp gives mantissa in [0.5, 1), so the position inside the octave is linear in it
+    const auto position = float((exponent - minExponent) * pointsPerOctave) + (mantissa - 0.5f) * 2.f * pointsPerOctave;
+    const auto index = juce::jlimit(0, numFrequencyPoints - 2, int(position));
+    const auto frac = double(position - float(index));
+
+    const auto& a = trigTerms[(size_t) index];
+    const auto& b = trigTerms[(size_t) index + 1];
+
+    return { a.tanHalfOmega + (b.tanHalfOmega - a.tanHalfOmega) * frac,
+             a.cosOmega + (b.cosOmega - a.cosOmega) * frac,
+             a.sinOmega + (b.sinOmega - a.sinOmega) * frac };
+}
+
+double CoefficientTables::getPeakGainFactor(float gainInDecibels) const
+{
+    const auto position = (juce::jlimit(minGainInDecibels, maxGainInDecibels, gainInDecibels) - minGainInDecibels) * gainPointsPerDecibel;
+    const auto index = juce::jlimit(0, (int) peakGainFactors.size() - 2, int(position));
+    const auto frac = double(position - float(index));
+
+    return peakGainFactors[(size_t) index] + (peakGainFactors[(size_t) index + 1] - peakGainFactors[(size_t) index]) * frac;
+}
+
+CoefficientTables::TrigTerms CoefficientTables::computeTrigTerms(double frequency, double sampleRate)
+{
+    const auto omega = juce::MathConstants<double>::twoPi * frequency / sampleRate;
+    return { std::tan(omega * 0.5), std::cos(omega), std::sin(omega) };
+}
+
+double CoefficientTables::computePeakGainFactor(float gainInDecibels)
+{
+    // same as juce::dsp::IIR::Coefficients::makePeakFilter's A
+    return std::sqrt(juce::jmax(0.0, double(juce::Decibels::decibelsToGain(gainInDecibels))));
+}
+
+double CoefficientTables::getButterworthQ(int order, int index)
+{
+    static const auto qs = []
+    {
+        std::array<std::array<double, maxCutSections>, maxCutSections> table {};
+
+        for (int sections = 1; sections <= maxCutSections; ++sections)
+        {
+            const auto n = 2 * sections;
+            for (int i = 0; i < sections; ++i)
+                table[(size_t) sections - 1][(size_t) i] = 1.0 / (2.0 * std::cos((2.0 * i + 1.0) * juce::MathConstants<double>::pi / (n * 2.0)));
+        }
+
+        return table;
+    }();
+
+    jassert(order % 2 == 0 && order / 2 <= maxCutSections && index < order / 2);
+    return qs[(size_t) order / 2 - 1][(size_t) index];
+}
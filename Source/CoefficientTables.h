@@ -0,0 +1,58 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <memory>
+#include <vector>
+
+/**
+ everything transcendental the filter designs need, tabulated for one sample rate.
+
+ frequencies sit on a grid with a fixed number of points per octave, spaced linearly
+ inside each octave, so finding an entry only takes std::frexp instead of a log.
+ lookups interpolate linearly between neighbouring entries.
+
+ tables are built at prepareToPlay and shared by every instance running at the same rate.
+ */
+class CoefficientTables
+{
+public:
+    struct TrigTerms
+    {
+        double tanHalfOmega;  // tan(pi * f / fs), used by the cut filters
+        double cosOmega;      // cos(2 * pi * f / fs), used by the peak filter
+        double sinOmega;      // sin(2 * pi * f / fs)
+    };
+
+    explicit CoefficientTables(double sampleRateToUse);
+
+    static std::shared_ptr<const CoefficientTables> getFor(double sampleRate);
+
+    double getSampleRate() const { return sampleRate; }
+
+    TrigTerms getTrigTerms(float frequency) const;
+    double getPeakGainFactor(float gainInDecibels) const;
+
+    // the exact values the tables are built from
+    static TrigTerms computeTrigTerms(double frequency, double sampleRate);
+    static double computePeakGainFactor(float gainInDecibels);
+
+    // Q of section 'index' of an even order butterworth filter
+    static double getButterworthQ(int order, int index);
+
+private:
+    static constexpr int pointsPerOctave = 256;
+    static constexpr int minExponent = 1;   // 1 Hz
+    static constexpr int maxExponent = 16;  // 32768 Hz
+    static constexpr int numFrequencyPoints = (maxExponent - minExponent) * pointsPerOctave + 1;
+
+    static constexpr float minGainInDecibels = -24.f, maxGainInDecibels = 24.f;
+    static constexpr float gainPointsPerDecibel = 4.f;
+
+    double sampleRate;
+    float maxFrequency;
+
+    std::vector<TrigTerms> trigTerms;
+    std::vector<double> peakGainFactors;
+
+    static double getFrequencyForIndex(int index);
+};
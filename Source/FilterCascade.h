@@ -0,0 +1,135 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+#include <array>
+
+// one normalised biquad section (a0 == 1), designed without touching the heap. kept in double
+// so the double precision path gets the full design, the float path rounds once when flattening
+struct BiquadCoefficients
+{
+    double b0 { 1.0 }, b1 { 0.0 }, b2 { 0.0 }, a1 { 0.0 }, a2 { 0.0 };
+};
+
+// each cut filter section adds 12 dB/Oct. steeper slopes only need a bigger number here
+// (and the matching Slope choices), the processing kernel sizes itself from it
+constexpr int maxCutSections = 4;
+
+// low cut sections + peak + high cut sections
+constexpr int maxCascadeSections = 2 * maxCutSections + 1;
+
+/**
+ every active biquad of the chain, in processing order, laid out as structure-of-arrays.
+ bypassed bands and unused cut sections are simply left out.
+ */
+template<typename FloatType>
+struct CascadeCoefficients
+{
+    void clear() { numSections = 0; }
+
+    void add(const BiquadCoefficients& c)
+    {
+        jassert(numSections < maxCascadeSections);
+        b0[numSections] = FloatType(c.b0);
+        b1[numSections] = FloatType(c.b1);
+        b2[numSections] = FloatType(c.b2);
+        a1[numSections] = FloatType(c.a1);
+        a2[numSections] = FloatType(c.a2);
+        ++numSections;
+    }
+
+    int numSections = 0;
+    std::array<FloatType, maxCascadeSections> b0 {}, b1 {}, b2 {}, a1 {}, a2 {};
+};
+
+// the scalar behind a sample type, a SIMDRegister<float> is filtered with float coefficients
+template<typename SampleType>
+struct ScalarTypeOf { using Type = SampleType; };
+
+template<typename ElementType>
+struct ScalarTypeOf<juce::dsp::SIMDRegister<ElementType>> { using Type = ElementType; };
+
+/**
+ runs all sections of a CascadeCoefficients in one pass over the samples (transposed direct form II).
+ the loop is instantiated for every possible section count, so the per-sample work is fully unrolled
+ and the state lives in registers. SampleType is float or double, or a SIMDRegister of either to run
+ several channels at once.
+ */
+template<typename SampleType>
+struct FilterCascade
+{
+    using Coefficients = CascadeCoefficients<typename ScalarTypeOf<SampleType>::Type>;
+
+    void reset()
+    {
+        s1.fill(SampleType { 0 });
+        s2.fill(SampleType { 0 });
+    }
+
+    void process(const Coefficients& coefficients, SampleType* data, size_t numSamples)
+    {
+        dispatch<maxCascadeSections>(coefficients, data, numSamples);
+    }
+
+    // after sections were added to or left out of the coefficients: section k carries on from the
+    // state of what was section previousPosition[k], or starts from zero where that's negative
+    void moveState(const std::array<int, maxCascadeSections>& previousPosition)
+    {
+        const auto old1 = s1, old2 = s2;
+
+        for (size_t k = 0; k < previousPosition.size(); ++k)
+        {
+            const auto from = previousPosition[k];
+            s1[k] = from >= 0 ? old1[(size_t) from] : SampleType { 0 };
+            s2[k] = from >= 0 ? old2[(size_t) from] : SampleType { 0 };
+        }
+    }
+
+private:
+    std::array<SampleType, maxCascadeSections> s1, s2;
+
+    template<int NumSections>
+    void dispatch(const Coefficients& coefficients, SampleType* data, size_t numSamples)
+    {
+        if (coefficients.numSections == NumSections)
+            processSections<NumSections>(coefficients, data, numSamples);
+        else if constexpr (NumSections > 0)
+            dispatch<NumSections - 1>(coefficients, data, numSamples);
+    }
+
+    template<int NumSections>
+    void processSections(const Coefficients& c, SampleType* data, size_t numSamples)
+    {
+        if constexpr (NumSections > 0)
+        {
+            std::array<SampleType, NumSections> z1, z2;
+            for (int k = 0; k < NumSections; ++k)
+            {
+                z1[k] = s1[k];
+                z2[k] = s2[k];
+            }
+
+            for (size_t i = 0; i < numSamples; ++i)
+            {
+                auto x = data[i];
+
+                for (int k = 0; k < NumSections; ++k)
+                {
+                    const auto y = x * c.b0[k] + z1[k];
+                    z1[k] = x * c.b1[k] - y * c.a1[k] + z2[k];
+                    z2[k] = x * c.b2[k] - y * c.a2[k];
+                    x = y;
+                }
+
+                data[i] = x;
+            }
+
+            for (int k = 0; k < NumSections; ++k)
+            {
+                juce::dsp::util::snapToZero(z1[k]);
+                juce::dsp::util::snapToZero(z2[k]);
+                s1[k] = z1[k];
+                s2[k] = z2[k];
+            }
+        }
+    }
+};
@@ -0,0 +1,117 @@
+#include "FrequencyResponse.h"
+#include "PluginProcessor.h"
+
+void FrequencyResponse::prepare(const double* frequencies, int numFrequenciesToUse, double sampleRateToUse)
+{
+    numFrequencies = numFrequenciesToUse;
+    sampleRate = sampleRateToUse;
+
+    const auto n = (size_t) numFrequencies;
+
+    for (auto* table : { &cos1, &sin1, &cos2, &sin2, &numRe, &numIm, &denRe, &denIm, &delay })
+        table->resize(n);
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        const auto omega = juce::MathConstants<double>::twoPi * frequencies[i] / sampleRate;
+
+        cos1[i] = std::cos(omega);
+        sin1[i] = std::sin(omega);
+        cos2[i] = std::cos(2.0 * omega);
+        sin2[i] = std::sin(2.0 * omega);
+    }
+}
+
+void FrequencyResponse::prepareLogarithmic(double minFrequency, double maxFrequency, int numFrequenciesToUse, double sampleRateToUse)
+{
+    // the i'th point i / numFrequencies of the way along, like one per pixel column
+    std::vector<double> frequencies((size_t) numFrequenciesToUse);
+    for (int i = 0; i < numFrequenciesToUse; ++i)
+        frequencies[(size_t) i] = juce::mapToLog10(double(i) / double(numFrequenciesToUse), minFrequency, maxFrequency);
+
+    prepare(frequencies.data(), numFrequenciesToUse, sampleRateToUse);
+}
+
+void FrequencyResponse::evaluate(const CascadeCoefficients<double>& cascade, const Result& result)
+{
+    const auto n = (size_t) numFrequencies;
+
+    std::fill(numRe.begin(), numRe.end(), 1.0);
+    std::fill(numIm.begin(), numIm.end(), 0.0);
+    std::fill(denRe.begin(), denRe.end(), 1.0);
+    std::fill(denIm.begin(), denIm.end(), 0.0);
+    std::fill(delay.begin(), delay.end(), 0.0);
+
+    const auto withDelay = result.groupDelay != nullptr;
+
+    for (int k = 0; k < cascade.numSections; ++k)
+    {
+        const auto b0 = cascade.b0[(size_t) k], b1 = cascade.b1[(size_t) k], b2 = cascade.b2[(size_t) k];
+        const auto a1 = cascade.a1[(size_t) k], a2 = cascade.a2[(size_t) k];
+
+        for (size_t i = 0; i < n; ++i)
+        {
+            // B = b0 + b1 e^-jw + b2 e^-2jw, A = 1 + a1 e^-jw + a2 e^-2jw
+            const auto bRe = b0 + b1 * cos1[i] + b2 * cos2[i];
+            const auto bIm = -(b1 * sin1[i] + b2 * sin2[i]);
+            const auto aRe = 1.0 + a1 * cos1[i] + a2 * cos2[i];
+            const auto aIm = -(a1 * sin1[i] + a2 * sin2[i]);
+
+            const auto nRe = numRe[i] * bRe - numIm[i] * bIm;
+            numIm[i] = numRe[i] * bIm + numIm[i] * bRe;
+            numRe[i] = nRe;
+
+            const auto dRe = denRe[i] * aRe - denIm[i] * aIm;
+            denIm[i] = denRe[i] * aIm + denIm[i] * aRe;
+            denRe[i] = dRe;
+        }
+
+        if (withDelay)
+        {
+            // the group delay of a polynomial P(e^-jw) = sum p_k e^-jwk is Re(P' / P), with P' = sum k p_k e^-jwk.
+            // for B / A it's the numerator's minus the denominator's, summed over the sections
+            for (size_t i = 0; i < n; ++i)
+            {
+                const auto bRe = b0 + b1 * cos1[i] + b2 * cos2[i];
+                const auto bIm = -(b1 * sin1[i] + b2 * sin2[i]);
+                const auto aRe = 1.0 + a1 * cos1[i] + a2 * cos2[i];
+                const auto aIm = -(a1 * sin1[i] + a2 * sin2[i]);
+
+                const auto dbRe = b1 * cos1[i] + 2.0 * b2 * cos2[i];
+                const auto dbIm = -(b1 * sin1[i] + 2.0 * b2 * sin2[i]);
+                const auto daRe = a1 * cos1[i] + 2.0 * a2 * cos2[i];
+                const auto daIm = -(a1 * sin1[i] + 2.0 * a2 * sin2[i]);
+
+                // a zero right on a grid point (a cut filter at DC) adds nothing rather than a NaN
+                delay[i] += (dbRe * bRe + dbIm * bIm) / std::max(bRe * bRe + bIm * bIm, 1e-300)
+                          - (daRe * aRe + daIm * aIm) / std::max(aRe * aRe + aIm * aIm, 1e-300);
+            }
+        }
+    }
+
+    if (result.gain != nullptr)
+        for (size_t i = 0; i < n; ++i)
+            result.gain[i] = (float) std::sqrt((numRe[i] * numRe[i] + numIm[i] * numIm[i])
+                                               / (denRe[i] * denRe[i] + denIm[i] * denIm[i]));
+
+    // same floor as juce::Decibels::gainToDecibels
+    if (result.decibels != nullptr)
+        for (size_t i = 0; i < n; ++i)
+            result.decibels[i] = (float) std::max(-100.0, 10.0 * std::log10((numRe[i] * numRe[i] + numIm[i] * numIm[i])
+                                                                             / (denRe[i] * denRe[i] + denIm[i] * denIm[i])));
+
+    // arg(N / D) = arg(N * conj(D))
+    if (result.phase != nullptr)
+        for (size_t i = 0; i < n; ++i)
+            result.phase[i] = (float) std::atan2(numIm[i] * denRe[i] - numRe[i] * denIm[i],
+                                                 numRe[i] * denRe[i] + numIm[i] * denIm[i]);
+
+    if (withDelay)
+        for (size_t i = 0; i < n; ++i)
+            result.groupDelay[i] = (float) delay[i];
+}
+
+void FrequencyResponse::evaluate(const ChainSettings& chainSettings, const Result& result)
+{
+    evaluate(makeCascadeCoefficients(chainSettings, sampleRate), result);
+}
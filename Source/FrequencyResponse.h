@@ -0,0 +1,54 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <vector>
+#include "FilterCascade.h"
+
+struct ChainSettings;
+
+/**
+ magnitude, phase & group delay of a whole cascade over a fixed set of frequencies, in one call.
+
+ the cos / sin terms of every frequency are computed once in prepare(). evaluate() then runs section
+ by section over all frequencies at once, on structure-of-arrays accumulators, so the inner loops are
+ plain arithmetic the compiler vectorises across frequencies. that's what the response curve, the
+ linear phase design and offline tools use to evaluate a cascade.
+
+ keeps scratch space, so one instance per thread.
+ */
+class FrequencyResponse
+{
+public:
+    // allocates. 'frequencies' in Hz
+    void prepare(const double* frequencies, int numFrequencies, double sampleRate);
+
+    // numFrequencies points from 'minFrequency' to 'maxFrequency', evenly spaced on a log axis
+    void prepareLogarithmic(double minFrequency, double maxFrequency, int numFrequencies, double sampleRate);
+
+    int getNumFrequencies() const { return numFrequencies; }
+    double getSampleRate() const { return sampleRate; }
+
+    // where the results go, getNumFrequencies() values each. anything left nullptr isn't computed
+    struct Result
+    {
+        float* gain = nullptr;          // linear
+        float* decibels = nullptr;
+        float* phase = nullptr;         // radians, wrapped to [-pi, pi]
+        float* groupDelay = nullptr;    // samples
+    };
+
+    void evaluate(const CascadeCoefficients<double>& cascade, const Result& result);
+
+    // the whole chain as the processor would run it at getSampleRate()
+    void evaluate(const ChainSettings& chainSettings, const Result& result);
+
+private:
+    int numFrequencies = 0;
+    double sampleRate = 0;
+
+    // e^-jw & e^-2jw per frequency
+    std::vector<double> cos1, sin1, cos2, sin2;
+
+    // running products of all numerators & denominators, and the summed group delay
+    std::vector<double> numRe, numIm, denRe, denIm, delay;
+};
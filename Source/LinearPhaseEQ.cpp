@@ -0,0 +1,225 @@
+#include "LinearPhaseEQ.h"
+#include "PluginProcessor.h"
+
+LinearPhaseEQ::LinearPhaseEQ(juce::AudioProcessorValueTreeState& apvtsToUse) :
+apvts(apvtsToUse)
+{
+    partitionParam = apvts.getRawParameterValue("Linear Phase Partition");
+}
+
+LinearPhaseEQ::~LinearPhaseEQ()
+{
+    // waits for a running design to finish
+    designThread->removeTimeSliceClient(this);
+
+    delete pendingConvolver.exchange(nullptr);
+    delete retiredConvolver.exchange(nullptr);
+}
+
+const juce::StringArray& LinearPhaseEQ::getPartitionSizeChoices()
+{
+    static const juce::StringArray choices { "256", "512", "1024", "2048" };
+    return choices;
+}
+
+int LinearPhaseEQ::getRequestedPartitionSize() const
+{
+    const auto& choices = getPartitionSizeChoices();
+    return choices[juce::jlimit(0, choices.size() - 1, (int) partitionParam->load())].getIntValue();
+}
+
+void LinearPhaseEQ::prepare(double newSampleRate, int newNumChannels, int maxBlockSize)
+{
+    designThread->removeTimeSliceClient(this);
+
+    delete pendingConvolver.exchange(nullptr);
+    delete retiredConvolver.exchange(nullptr);
+    incomingConvolver.reset();
+    handingOver = false;
+
+    sampleRate = newSampleRate;
+    numChannels = newNumChannels;
+
+    // ~170ms of FIR whatever the rate, enough to resolve the low cut at 20 Hz
+    firLength = juce::nextPowerOfTwo(int(sampleRate / 6.0));
+
+    int order = 0;
+    while ((1 << order) < firLength)
+        ++order;
+
+    designFFT = std::make_unique<juce::dsp::FFT>(order);
+    impulseResponse.assign((size_t) firLength, 0.f);
+    designBuffer.assign((size_t) (2 * firLength), 0.f);
+
+    std::vector<double> binFrequencies((size_t) (firLength / 2 + 1));
+    for (size_t k = 0; k < binFrequencies.size(); ++k)
+        binFrequencies[k] = double(k) * sampleRate / double(firLength);
+
+    designResponse.prepare(binFrequencies.data(), (int) binFrequencies.size(), sampleRate);
+    designGains.assign(binFrequencies.size(), 0.f);
+    // one point longer than the FIR, so the window peaks exactly on its centre sample
+    window.assign((size_t) firLength + 1, 0.f);
+    juce::dsp::WindowingFunction<float>::fillWindowingTables(window.data(), (size_t) firLength + 1,
+                                                             juce::dsp::WindowingFunction<float>::blackman, false);
+
+    // the incoming convolver gets its own copy of the input while it warms up
+    incomingBuffer.setSize(numChannels, maxBlockSize);
+
+    activeConvolver = std::make_unique<PartitionedConvolver>(getRequestedPartitionSize(), firLength, numChannels);
+    latestConvolver = activeConvolver.get();
+
+    dirty = false;
+    designImpulseResponse();
+    activeConvolver->loadImpulseResponse(impulseResponse.data(), firLength, false);
+
+    designThread->addTimeSliceClient(this);
+}
+
+void LinearPhaseEQ::process(juce::dsp::AudioBlock<float>& block)
+{
+    // a convolver with a new partition size is waiting, start warming it up
+    if (incomingConvolver == nullptr)
+    {
+        if (auto* next = pendingConvolver.exchange(nullptr))
+        {
+            incomingConvolver.reset(next);
+
+            // its output is whole once the full FIR has been through its delay line
+            warmUpRemaining = firLength + next->getPartitionSize();
+            crossfadePosition = 0;
+        }
+    }
+
+    if (incomingConvolver != nullptr)
+        processHandover(block);
+    else
+        activeConvolver->process(block);
+}
+
+void LinearPhaseEQ::processHandover(juce::dsp::AudioBlock<float>& block)
+{
+    const auto numSamples = (int) block.getNumSamples();
+    const auto numChannelsToProcess = juce::jmin((int) block.getNumChannels(), incomingBuffer.getNumChannels());
+    jassert(numSamples <= incomingBuffer.getNumSamples());
+
+    auto incomingBlock = juce::dsp::AudioBlock<float>(incomingBuffer).getSubsetChannelBlock(0, (size_t) numChannelsToProcess)
+                                                                     .getSubBlock(0, (size_t) numSamples);
+    incomingBlock.copyFrom(block.getSubsetChannelBlock(0, (size_t) numChannelsToProcess));
+
+    activeConvolver->process(block);
+    incomingConvolver->process(incomingBlock);
+
+    if (warmUpRemaining > 0)
+    {
+        warmUpRemaining -= numSamples;
+        return;
+    }
+
+    for (int ch = 0; ch < numChannelsToProcess; ++ch)
+    {
+        auto* out = block.getChannelPointer((size_t) ch);
+        const auto* in = incomingBlock.getChannelPointer((size_t) ch);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const auto ramp = juce::jmin(1.f, float(crossfadePosition + i + 1) / float(crossfadeLength));
+            out[i] += (in[i] - out[i]) * ramp;
+        }
+    }
+
+    crossfadePosition += numSamples;
+    if (crossfadePosition < crossfadeLength)
+        return;
+
+    // the design thread frees the last one before it builds another, so the slot is always empty here
+    jassert(retiredConvolver.load() == nullptr);
+    retiredConvolver = activeConvolver.release();
+    activeConvolver = std::move(incomingConvolver);
+    handingOver = false;
+}
+
+void LinearPhaseEQ::reset()
+{
+    activeConvolver->reset();
+
+    // a handover in progress starts warming up again from silence
+    if (incomingConvolver != nullptr)
+    {
+        incomingConvolver->reset();
+        warmUpRemaining = firLength + incomingConvolver->getPartitionSize();
+        crossfadePosition = 0;
+    }
+}
+
+int LinearPhaseEQ::getLatencySamples() const
+{
+    // half the symmetric FIR plus one partition of input buffering
+    return firLength / 2 + activeConvolver->getPartitionSize();
+}
+
+int LinearPhaseEQ::useTimeSlice()
+{
+    if (latestConvolver == nullptr)
+        return 100;
+
+    // one handover at a time. new responses wait for it too, the incoming convolver already has the latest
+    if (handingOver.load())
+        return 10;
+
+    // the audio thread retires the old convolver before it clears handingOver, it's ours to free
+    delete retiredConvolver.exchange(nullptr);
+
+    const auto partitionSize = getRequestedPartitionSize();
+    if (partitionSize != latestConvolver->getPartitionSize())
+    {
+        if (dirty.exchange(false))
+            designImpulseResponse();
+
+        auto convolver = std::make_unique<PartitionedConvolver>(partitionSize, firLength, numChannels);
+        convolver->loadImpulseResponse(impulseResponse.data(), firLength, false);
+
+        latestConvolver = convolver.get();
+        handingOver = true;
+        pendingConvolver = convolver.release();
+        return 10;
+    }
+
+    // the previous response may still be crossfading in
+    if (dirty.load() && latestConvolver->isReadyForNewImpulseResponse())
+    {
+        dirty = false;
+        designImpulseResponse();
+        latestConvolver->loadImpulseResponse(impulseResponse.data(), firLength, true);
+    }
+
+    return 10;
+}
+
+void LinearPhaseEQ::designImpulseResponse()
+{
+    const auto numBins = firLength / 2 + 1;
+
+    FrequencyResponse::Result result;
+    result.gain = designGains.data();
+    designResponse.evaluate(getChainSettings(apvts), result);
+
+    // zero phase spectrum with the chain's magnitude response...
+    for (int k = 0; k < numBins; ++k)
+    {
+        designBuffer[(size_t) (2 * k)] = designGains[(size_t) k];
+        designBuffer[(size_t) (2 * k + 1)] = 0.f;
+    }
+
+    for (int k = numBins; k < firLength; ++k)
+    {
+        designBuffer[(size_t) (2 * k)] = designBuffer[(size_t) (2 * (firLength - k))];
+        designBuffer[(size_t) (2 * k + 1)] = 0.f;
+    }
+
+    designFFT->performRealOnlyInverseTransform(designBuffer.data());
+
+    // ...is a symmetric impulse around sample 0, rotate it to the middle and window it
+    const auto centre = firLength / 2;
+    for (int n = 0; n < firLength; ++n)
+        impulseResponse[(size_t) n] = designBuffer[(size_t) ((n + centre) % firLength)] * window[(size_t) n];
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <juce_dsp/juce_dsp.h>
+#include <atomic>
+#include <vector>
+#include "PartitionedConvolver.h"
+#include "FrequencyResponse.h"
+
+/**
+ linear phase version of the whole chain: the magnitude response of the current ChainSettings
+ (the same curve the editor draws) turned into a symmetric FIR and run through a PartitionedConvolver.
+
+ the FIR is redesigned on a background thread shared by all instances whenever a filter
+ parameter changes, and crossfaded in. changing the partition size builds a new convolver on the
+ same thread. the audio thread runs it next to the old one until its delay line is full, then
+ crossfades over to it, so the switch never drops out. the latency moves with the crossfade.
+ */
+class LinearPhaseEQ : private juce::TimeSliceClient
+{
+public:
+    explicit LinearPhaseEQ(juce::AudioProcessorValueTreeState& apvtsToUse);
+    ~LinearPhaseEQ() override;
+
+    static const juce::StringArray& getPartitionSizeChoices();
+
+    // message thread, while audio isn't running. designs the first FIR synchronously
+    void prepare(double sampleRate, int numChannels, int maxBlockSize);
+
+    // any thread, asks for the FIR to be redesigned
+    void markDirty() { dirty = true; }
+
+    // audio thread
+    void process(juce::dsp::AudioBlock<float>& block);
+    void reset();
+    int getLatencySamples() const;
+
+private:
+    struct DesignThread : juce::TimeSliceThread
+    {
+        DesignThread() : juce::TimeSliceThread("SimpleEQ Linear Phase Design") { startThread(); }
+        ~DesignThread() override { stopThread(2000); }
+    };
+
+    juce::AudioProcessorValueTreeState& apvts;
+    std::atomic<float>* partitionParam = nullptr;
+    juce::SharedResourcePointer<DesignThread> designThread;
+
+    double sampleRate = 44100.0;
+    int numChannels = 2, firLength = 0;
+
+    // the audio thread plays activeConvolver. the design thread builds into latestConvolver (the
+    // newest one, whichever thread has it) and hands over / takes back whole convolvers through the atomics
+    std::unique_ptr<PartitionedConvolver> activeConvolver;
+    PartitionedConvolver* latestConvolver = nullptr;
+    std::atomic<PartitionedConvolver*> pendingConvolver { nullptr }, retiredConvolver { nullptr };
+
+    // set by the design thread with a new pending convolver, cleared by the audio thread once it has taken over
+    std::atomic<bool> handingOver { false };
+
+    // audio thread: a convolver with a new partition size, warming up next to activeConvolver
+    std::unique_ptr<PartitionedConvolver> incomingConvolver;
+    juce::AudioBuffer<float> incomingBuffer;
+    int warmUpRemaining = 0, crossfadePosition = 0;
+    static constexpr int crossfadeLength = 2048;
+
+    void processHandover(juce::dsp::AudioBlock<float>& block);
+
+    std::atomic<bool> dirty { false };
+
+    // design thread scratch
+    std::unique_ptr<juce::dsp::FFT> designFFT;
+    std::vector<float> impulseResponse, designBuffer, window, designGains;
+    FrequencyResponse designResponse;  // at the FFT's bin frequencies
+
+    int useTimeSlice() override;
+    int getRequestedPartitionSize() const;
+    void designImpulseResponse();
+};
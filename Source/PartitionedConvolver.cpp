@@ -0,0 +1,177 @@
+#include "PartitionedConvolver.h"
+
+static int getFFTOrder(int size)
+{
+    int order = 0;
+    while ((1 << order) < size)
+        ++order;
+
+    return order;
+}
+
+PartitionedConvolver::PartitionedConvolver(int partitionSizeToUse, int maxImpulseResponseLength, int numChannelsToUse) :
+partitionSize(partitionSizeToUse),
+fftSize(2 * partitionSizeToUse),
+numBins(partitionSizeToUse + 1),
+numPartitions(juce::jmax(1, (maxImpulseResponseLength + partitionSizeToUse - 1) / partitionSizeToUse)),
+numChannels(numChannelsToUse),
+spectrumSize(2 * (partitionSizeToUse + 1)),
+fft(getFFTOrder(2 * partitionSizeToUse))
+{
+    jassert(juce::isPowerOfTwo(partitionSize));
+
+    for (auto& spectra : impulseResponseSpectra)
+        spectra.assign((size_t) (numPartitions * spectrumSize), 0.f);
+
+    channels.resize((size_t) numChannels);
+    for (auto& channel : channels)
+    {
+        channel.input.assign((size_t) fftSize, 0.f);
+        channel.delayLine.assign((size_t) (numPartitions * spectrumSize), 0.f);
+        channel.output.assign((size_t) partitionSize, 0.f);
+    }
+
+    // the real-only transforms work in place on 2 * fftSize floats
+    fftBuffer.assign((size_t) (2 * fftSize), 0.f);
+    crossfadeBuffer.assign((size_t) (2 * fftSize), 0.f);
+}
+
+void PartitionedConvolver::loadImpulseResponse(const float* impulseResponse, int length, bool crossfade)
+{
+    jassert(isReadyForNewImpulseResponse());
+
+    const auto slot = 1 - activeSlot.load();
+    auto& spectra = impulseResponseSpectra[slot];
+
+    // not 'fft' or 'fftBuffer', the audio thread may be using those right now
+    juce::dsp::FFT loadFFT(getFFTOrder(fftSize));
+    std::vector<float> buffer((size_t) (2 * fftSize));
+
+    for (int p = 0; p < numPartitions; ++p)
+    {
+        std::fill(buffer.begin(), buffer.end(), 0.f);
+
+        const auto start = p * partitionSize;
+        const auto count = juce::jlimit(0, partitionSize, length - start);
+        if (count > 0)
+            std::copy(impulseResponse + start, impulseResponse + start + count, buffer.begin());
+
+        loadFFT.performRealOnlyForwardTransform(buffer.data(), true);
+        std::copy(buffer.begin(), buffer.begin() + spectrumSize, spectra.begin() + p * spectrumSize);
+    }
+
+    if (crossfade)
+        pendingSlotReady = true;
+    else
+        activeSlot = slot;
+}
+
+void PartitionedConvolver::reset()
+{
+    for (auto& channel : channels)
+    {
+        std::fill(channel.input.begin(), channel.input.end(), 0.f);
+        std::fill(channel.delayLine.begin(), channel.delayLine.end(), 0.f);
+        std::fill(channel.output.begin(), channel.output.end(), 0.f);
+    }
+
+    delayLinePosition = 0;
+    inputPosition = 0;
+}
+
+void PartitionedConvolver::process(juce::dsp::AudioBlock<float>& block)
+{
+    const auto numSamples = (int) block.getNumSamples();
+    const auto numChannelsToProcess = juce::jmin((int) block.getNumChannels(), numChannels);
+
+    for (int done = 0; done < numSamples;)
+    {
+        // collect input & hand out the previous partition's output until the partition is full
+        const auto count = juce::jmin(partitionSize - inputPosition, numSamples - done);
+
+        for (int ch = 0; ch < numChannelsToProcess; ++ch)
+        {
+            auto* data = block.getChannelPointer((size_t) ch) + done;
+            auto& channel = channels[(size_t) ch];
+
+            std::copy(data, data + count, channel.input.begin() + partitionSize + inputPosition);
+            std::copy(channel.output.begin() + inputPosition, channel.output.begin() + inputPosition + count, data);
+        }
+
+        inputPosition += count;
+        done += count;
+
+        if (inputPosition == partitionSize)
+        {
+            const bool crossfade = pendingSlotReady.load();
+
+            for (int ch = 0; ch < numChannelsToProcess; ++ch)
+                processPartition(channels[(size_t) ch], crossfade);
+
+            delayLinePosition = (delayLinePosition + 1) % numPartitions;
+            inputPosition = 0;
+
+            if (crossfade)
+            {
+                // the old slot is free for the next response from here on
+                activeSlot = 1 - activeSlot.load();
+                pendingSlotReady = false;
+            }
+        }
+    }
+}
+
+void PartitionedConvolver::processPartition(ChannelState& channel, bool crossfade)
+{
+    std::copy(channel.input.begin(), channel.input.end(), fftBuffer.begin());
+    std::fill(fftBuffer.begin() + fftSize, fftBuffer.end(), 0.f);
+    fft.performRealOnlyForwardTransform(fftBuffer.data(), true);
+    std::copy(fftBuffer.begin(), fftBuffer.begin() + spectrumSize, channel.delayLine.begin() + delayLinePosition * spectrumSize);
+
+    // slide the input along for the next partition
+    std::copy(channel.input.begin() + partitionSize, channel.input.end(), channel.input.begin());
+
+    // overlap-save: only the second half of the circular convolution is valid output
+    const auto slot = activeSlot.load();
+    convolve(channel, slot, fftBuffer);
+    std::copy(fftBuffer.begin() + partitionSize, fftBuffer.begin() + fftSize, channel.output.begin());
+
+    if (crossfade)
+    {
+        convolve(channel, 1 - slot, crossfadeBuffer);
+
+        for (int i = 0; i < partitionSize; ++i)
+        {
+            const auto ramp = (float(i) + 0.5f) / float(partitionSize);
+            auto& out = channel.output[(size_t) i];
+            out += (crossfadeBuffer[(size_t) (partitionSize + i)] - out) * ramp;
+        }
+    }
+}
+
+void PartitionedConvolver::convolve(const ChannelState& channel, int slot, std::vector<float>& result) const
+{
+    auto* acc = result.data();
+    std::fill(result.begin(), result.begin() + spectrumSize, 0.f);
+
+    for (int p = 0; p < numPartitions; ++p)
+    {
+        const auto* x = channel.delayLine.data() + ((delayLinePosition - p + numPartitions) % numPartitions) * spectrumSize;
+        const auto* h = impulseResponseSpectra[slot].data() + p * spectrumSize;
+
+        for (int k = 0; k < spectrumSize; k += 2)
+        {
+            acc[k]     += x[k] * h[k]     - x[k + 1] * h[k + 1];
+            acc[k + 1] += x[k] * h[k + 1] + x[k + 1] * h[k];
+        }
+    }
+
+    // mirror the negative frequencies for the inverse transform
+    for (int k = numBins; k < fftSize; ++k)
+    {
+        acc[2 * k] = acc[2 * (fftSize - k)];
+        acc[2 * k + 1] = -acc[2 * (fftSize - k) + 1];
+    }
+
+    fft.performRealOnlyInverseTransform(acc);
+}
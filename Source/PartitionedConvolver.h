@@ -0,0 +1,58 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+#include <atomic>
+#include <vector>
+
+/**
+ uniformly partitioned overlap-save convolver.
+
+ the impulse response is cut into partitionSize long pieces, each transformed once with a
+ 2 * partitionSize FFT. every partitionSize input samples, one FFT of the input goes into a
+ frequency domain delay line, gets multiplied against all partitions and one inverse FFT
+ produces the next partitionSize output samples, so the latency is exactly partitionSize.
+
+ there are two impulse response slots. a new response is written into the slot not being played
+ and crossfaded in over one partition, so nothing is allocated on the audio thread.
+ */
+class PartitionedConvolver
+{
+public:
+    PartitionedConvolver(int partitionSizeToUse, int maxImpulseResponseLength, int numChannelsToUse);
+
+    int getPartitionSize() const { return partitionSize; }
+
+    // any thread but the audio thread. with crossfade == false the slot becomes active straight
+    // away, which is only safe before the convolver is handed to the audio thread
+    bool isReadyForNewImpulseResponse() const { return ! pendingSlotReady.load(); }
+    void loadImpulseResponse(const float* impulseResponse, int length, bool crossfade);
+
+    // audio thread
+    void process(juce::dsp::AudioBlock<float>& block);
+    void reset();
+
+private:
+    struct ChannelState
+    {
+        std::vector<float> input;           // the last 2 * partitionSize input samples
+        std::vector<float> delayLine;       // numPartitions input spectra
+        std::vector<float> output;          // partitionSize samples, handed out over the next partition
+    };
+
+    const int partitionSize, fftSize, numBins, numPartitions, numChannels;
+    const int spectrumSize;                 // floats per spectrum, numBins interleaved complex values
+
+    juce::dsp::FFT fft;
+
+    std::vector<float> impulseResponseSpectra[2];
+    std::atomic<int> activeSlot { 0 };
+    std::atomic<bool> pendingSlotReady { false };
+
+    std::vector<ChannelState> channels;
+    int delayLinePosition = 0, inputPosition = 0;
+
+    std::vector<float> fftBuffer, crossfadeBuffer;
+
+    void processPartition(ChannelState& channel, bool crossfade);
+    void convolve(const ChannelState& channel, int slot, std::vector<float>& result) const;
+};
@@ -0,0 +1,100 @@
+#include "PipelineProfiler.h"
+#include <algorithm>
+
+const char* PipelineProfiler::getStageName(Stage stage)
+{
+    switch (stage)
+    {
+        case Stage::fft:            return "fft";
+        case Stage::traces:         return "traces";
+        case Stage::responseCurve:  return "response curve";
+        case Stage::paint:          return "paint";
+        case Stage::numStages:      break;
+    }
+
+    return "";
+}
+
+void PipelineProfiler::setEnabled(bool shouldBeEnabled)
+{
+    // a stage that's halfway through a record() right now may still land in the fresh window,
+    // that's one sample out of historySize
+    if (shouldBeEnabled && ! isEnabled())
+    {
+        for (auto& history : histories)
+        {
+            history.numWritten.store(0, std::memory_order_relaxed);
+            history.numDropped.store(0, std::memory_order_relaxed);
+        }
+
+        numDroppedSamples.store(0, std::memory_order_relaxed);
+    }
+
+    enabled.store(shouldBeEnabled, std::memory_order_release);
+}
+
+void PipelineProfiler::record(Stage stage, double milliseconds)
+{
+    if (! isEnabled())
+        return;
+
+    auto& history = histories[(size_t) stage];
+
+    // the only writer of this stage, so the count can't move under us
+    const auto n = history.numWritten.load(std::memory_order_relaxed);
+    history.milliseconds[n % historySize].store((float) milliseconds, std::memory_order_relaxed);
+    history.numWritten.store(n + 1, std::memory_order_release);
+}
+
+void PipelineProfiler::addDropped(Stage stage, int numFrames)
+{
+    if (isEnabled() && numFrames > 0)
+        histories[(size_t) stage].numDropped.fetch_add(numFrames, std::memory_order_relaxed);
+}
+
+void PipelineProfiler::addDroppedSamples(int numSamples)
+{
+    if (isEnabled() && numSamples > 0)
+        numDroppedSamples.fetch_add(numSamples, std::memory_order_relaxed);
+}
+
+PipelineProfiler::Stats PipelineProfiler::getStats() const
+{
+    Stats stats;
+    std::array<float, historySize> window;
+
+    for (size_t s = 0; s < histories.size(); ++s)
+    {
+        const auto& history = histories[s];
+        auto& stageStats = stats.stages[s];
+
+        stageStats.numDropped = history.numDropped.load(std::memory_order_relaxed);
+
+        // the newest historySize durations. one being overwritten while it's copied is just a newer one
+        const auto numWritten = history.numWritten.load(std::memory_order_acquire);
+        const auto count = (int) std::min(numWritten, (uint32_t) historySize);
+
+        for (int i = 0; i < count; ++i)
+            window[(size_t) i] = history.milliseconds[(numWritten - 1 - (uint32_t) i) % historySize].load(std::memory_order_relaxed);
+
+        stageStats.numSamples = count;
+        if (count == 0)
+            continue;
+
+        std::sort(window.begin(), window.begin() + count);
+
+        double sum = 0;
+        for (int i = 0; i < count; ++i)
+            sum += window[(size_t) i];
+
+        // nearest rank: the smallest duration at least 99% of the window is no longer than
+        const auto p99Rank = (int) std::ceil(0.99 * count);
+
+        stageStats.minMs = window.front();
+        stageStats.meanMs = sum / count;
+        stageStats.p99Ms = window[(size_t) (p99Rank - 1)];
+    }
+
+    stats.numDroppedSamples = numDroppedSamples.load(std::memory_order_relaxed);
+    return stats;
+}
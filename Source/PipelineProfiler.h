@@ -0,0 +1,95 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+/**
+ timings of the editor's pipeline, to tell whether a sluggish display is the analyzer or the drawing.
+
+ every stage keeps its most recent durations in a ring of atomics. a stage is only ever recorded from
+ the one thread that runs it, and read from any other, so recording doesn't block or allocate.
+ min / mean / p99 are worked out from a copy of the ring when the stats are asked for.
+
+ nothing is recorded until setEnabled(true): while no one looks, a stage costs one relaxed load.
+ */
+class PipelineProfiler
+{
+public:
+    enum class Stage
+    {
+        fft,            // produceFFTDataForRendering, analyzer thread. drops are hops of audio lost on the way
+        traces,         // analyzer traces or spectrogram rows, analyzer thread
+        responseCurve,  // re-evaluating the response curve, message thread
+        paint,          // ResponseCurveComponent::paint, message thread
+        numStages
+    };
+
+    static constexpr int numStages = static_cast<int>(Stage::numStages);
+    static constexpr int historySize = 128;
+
+    static const char* getStageName(Stage stage);
+
+    struct StageStats
+    {
+        double minMs = 0, meanMs = 0, p99Ms = 0;
+        int numSamples = 0;             // in the window, at most historySize
+        juce::int64 numDropped = 0;     // frames lost because a fifo was full or its audio never arrived
+    };
+
+    struct Stats
+    {
+        std::array<StageStats, numStages> stages;
+        juce::int64 numDroppedSamples = 0;  // audio the analyzer's sample fifos had no room for
+
+        const StageStats& operator[](Stage stage) const { return stages[(size_t) stage]; }
+    };
+
+    // any thread. switching on starts every window & counter from scratch
+    void setEnabled(bool shouldBeEnabled);
+    bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+
+    // the stage's own thread
+    void record(Stage stage, double milliseconds);
+    void addDropped(Stage stage, int numFrames = 1);
+
+    // the analyzer thread
+    void addDroppedSamples(int numSamples);
+
+    // any thread. drops are counted since the profiler was last enabled
+    Stats getStats() const;
+
+    // times its own lifetime into 'stage', if the profiler is enabled when it starts
+    struct ScopedTimer
+    {
+        ScopedTimer(PipelineProfiler& p, Stage s) :
+        profiler(p), stage(s), start(p.isEnabled() ? juce::Time::getHighResolutionTicks() : 0) {}
+
+        ~ScopedTimer()
+        {
+            if (start != 0)
+                profiler.record(stage, 1000.0 * juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start));
+        }
+
+        PipelineProfiler& profiler;
+        const Stage stage;
+        const juce::int64 start;
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedTimer)
+    };
+
+private:
+    static_assert(juce::isPowerOfTwo(historySize), "the write count wraps around");
+
+    struct History
+    {
+        std::array<std::atomic<float>, historySize> milliseconds;
+        std::atomic<uint32_t> numWritten { 0 };
+        std::atomic<juce::int64> numDropped { 0 };
+    };
+
+    std::array<History, numStages> histories;
+    std::atomic<juce::int64> numDroppedSamples { 0 };
+    std::atomic<bool> enabled { false };
+};
@@ -218,10 +218,26 @@ juce::String RotarySliderWithLabels::getDisplayString() const
     return str;
 }
 //=============================================================================
+ResponseCurveComponent::AnalyserParameters::AnalyserParameters(juce::AudioProcessorValueTreeState& apvts) :
+enabled(apvts.getRawParameterValue("Analyser Enabled")),
+overlap(apvts.getRawParameterValue("Analyser Overlap")),
+resolution(apvts.getRawParameterValue("Analyser Resolution")),
+averaging(apvts.getRawParameterValue("Analyser Averaging")),
+peakHold(apvts.getRawParameterValue("Analyser Peak Hold")),
+peakDecay(apvts.getRawParameterValue("Analyser Peak Decay")),
+maxHold(apvts.getRawParameterValue("Analyser Max Hold")),
+mode(apvts.getRawParameterValue("Analyser Mode")),
+correlation(apvts.getRawParameterValue("Analyser Correlation")),
+multiResolution(apvts.getRawParameterValue("Analyser Multi-Resolution")),
+display(apvts.getRawParameterValue("Analyser Display")),
+binReduction(apvts.getRawParameterValue("Analyser Bin Reduction"))
+{
+}
+
 ResponseCurveComponent::ResponseCurveComponent(SimpleEQAudioProcessor& p) :
 processorRef(p),
-leftPathProducer(processorRef.leftChannelFifo),
-rightPathProducer(processorRef.rightChannelFifo)
+analyserParams(processorRef.apvts),
+pathProducer(processorRef.leftChannelFifo, processorRef.rightChannelFifo, profiler)
 {
     const auto& params = processorRef.getParameters();
     for (auto param : params)
@@ -229,11 +245,19 @@ rightPathProducer(processorRef.rightChannelFifo)
         param->addListener(this);
     }
 
-    updateChain();
+    shouldShowFFTAnalysis = analyserParams.enabled->load() > 0.5f;
+    processorRef.addAnalyserConsumer();
+
+    // paints every pixel, so the editor behind never needs repainting for it
+    setOpaque(true);
+
+    updateResponseCurve();
     startTimerHz(60);
 }
 
 ResponseCurveComponent::~ResponseCurveComponent() {
+    processorRef.removeAnalyserConsumer();
+
     const auto& params = processorRef.getParameters();
     for (auto param : params)
     {
@@ -246,176 +270,653 @@ void ResponseCurveComponent::parameterValueChanged(int parameterIndex, float new
     parametersChanged = true;
 }
 
-void PathProducer::process(juce::Rectangle<float> fftBounds, double sampleRate)
+void PathProducer::Band::prepare(FFTOrder order)
+{
+    // history for the largest window, so switching the resolution never loses samples
+    history.setSize(2, 1 << FFTOrder::maxFFTOrder);
+    history.clear();
+
+    for (auto& b : ballistics)
+        b.prepare((1 << FFTOrder::maxFFTOrder) / 2);
+
+    correlation.prepare((1 << FFTOrder::maxFFTOrder) / 2);
+
+    changeOrder(order);
+    reset();
+}
+
+void PathProducer::Band::changeOrder(FFTOrder order)
+{
+    fftDataGenerator.changeOrder(order);
+    resetTraces();
+}
+
+void PathProducer::Band::reset()
+{
+    numValidSamples = 0;
+    samplesSinceLastFrame = 0;
+    samplesSinceLastAnalysis = 0;
+    samplesLostSinceLastFrame = 0;
+
+    resetTraces();
+}
+
+void PathProducer::Band::resetTraces()
+{
+    for (auto& b : ballistics)
+        b.reset(fftDataGenerator.getFFTSize() / 2, negativeInfinity);
+
+    correlation.reset(fftDataGenerator.getFFTSize() / 2);
+    hasFrame = false;
+}
+
+float* PathProducer::Band::makeRoom(int channel, int numSamples)
+{
+    const auto historySize = history.getNumSamples();
+    jassert(numSamples <= historySize);
+
+    auto* data = history.getWritePointer(channel);
+
+    // nothing to slide, and std::copy onto itself isn't allowed
+    if (numSamples == 0)
+        return data + historySize;
+
+    // overlapping, towards the start
+    std::copy(data + numSamples, data + historySize, data);
+
+    return data + historySize - numSamples;
+}
+
+void PathProducer::Band::samplesAdded(int numWritten, int numArrived)
+{
+    numValidSamples = juce::jmin(history.getNumSamples(), numValidSamples + numWritten);
+    samplesSinceLastAnalysis += numArrived;
+    samplesSinceLastFrame += numArrived;
+    samplesLostSinceLastFrame += numArrived - numWritten;
+}
+
+bool PathProducer::Band::analyse(const Settings& currentSettings, double sampleRate, PipelineProfiler& profiler)
+{
+    const auto fftSize = fftDataGenerator.getFFTSize();
+    if (numValidSamples < fftSize)
+        return false;
+
+    // one analysis per hop at most, and never more than one per slice (i.e. per displayed frame)
+    // however small the host's blocks are
+    const auto hopSize = juce::jmax(1, juce::roundToInt(float(fftSize) * (1.f - currentSettings.overlap)));
+
+    if (samplesSinceLastFrame < hopSize)
+        return false;
+
+    samplesSinceLastFrame %= hopSize;
+
+    // the hops of audio that never reached the history had no chance of a frame of their own.
+    // (skipping hops to keep to one frame per slice is by design, that isn't counted)
+    profiler.addDropped(PipelineProfiler::Stage::fft, samplesLostSinceLastFrame / hopSize);
+    samplesLostSinceLastFrame %= hopSize;
+
+    const auto historySize = history.getNumSamples();
+
+    {
+        const PipelineProfiler::ScopedTimer timer(profiler, PipelineProfiler::Stage::fft);
+
+        // the frame is consumed below before the next one is produced, so the pool always has room
+        [[maybe_unused]] const auto produced
+            = fftDataGenerator.produceFFTDataForRendering(history.getReadPointer(0, historySize - fftSize),
+                                                          history.getReadPointer(1, historySize - fftSize),
+                                                          negativeInfinity);
+        jassert(produced);
+    }
+
+    const auto seconds = double(samplesSinceLastAnalysis) / sampleRate;
+    samplesSinceLastAnalysis = 0;
+
+    auto processFrame = [&](const float* frame, int numBins)
+    {
+        auto spectrum = [frame, numBins](Spectrum s) { return frame + static_cast<int>(s) * numBins; };
+
+        for (int s = 0; s < numDecibelSpectra; ++s)
+            ballistics[(size_t) s].process(spectrum(static_cast<Spectrum>(s)), seconds,
+                                           currentSettings.averagingTime, currentSettings.peakDecayPerSecond);
+
+        if (currentSettings.correlation)
+            correlation.process(spectrum(Spectrum::crossPower), spectrum(Spectrum::leftPower), spectrum(Spectrum::rightPower),
+                                seconds, currentSettings.averagingTime, negativeInfinity);
+    };
+
+    // frames are read in place & handed straight back to the pool
+    bool analysed = false;
+    while (fftDataGenerator.getFFTData(processFrame))
+        analysed = true;
+
+    hasFrame = hasFrame || analysed;
+    return analysed;
+}
+
+void PathProducer::prepareDecimation(double sampleRate)
+{
+    decimationSampleRate = sampleRate;
+
+    decimationFactor = 1;
+    while (sampleRate / double(2 * decimationFactor) >= minimumLowBandRate)
+        decimationFactor *= 2;
+
+    // 48 dB/Oct butterworth, a couple of octaves below the low band's nyquist
+    ChainSettings antiAliasing;
+    antiAliasing.highCutFreq = lowBandCutoff;
+    antiAliasing.highCutSlope = Slope::Slope_48;
+
+    const auto sections = makeHighCutFilter(antiAliasing, sampleRate);
+
+    decimationCoefficients.clear();
+    for (int i = 0; i < getNumCutSections(antiAliasing.highCutSlope); ++i)
+        decimationCoefficients.add(sections[(size_t) i]);
+
+    resetLowBand();
+}
+
+void PathProducer::resetLowBand()
 {
-    juce::AudioBuffer<float> tempIncomingBuffer;
+    for (auto& filter : decimationFilters)
+        filter.reset();
 
-    while (leftChannelFifo->getAudioBuffer(tempIncomingBuffer) > 0)
+    decimationPhase = 0;
+    lowBand.reset();
+}
+
+void PathProducer::decimate(int numSamples)
+{
+    const auto historySize = fullBand.history.getNumSamples();
+
+    // every decimationFactor'th sample from decimationPhase on
+    const auto numOut = decimationPhase < numSamples ? (numSamples - 1 - decimationPhase) / decimationFactor + 1 : 0;
+
+    for (int channel = 0; channel < 2; ++channel)
     {
-        // send to fft data generator
-        auto size = tempIncomingBuffer.getNumSamples();
+        auto* scratch = decimationScratch.data();
+        juce::FloatVectorOperations::copy(scratch, fullBand.history.getReadPointer(channel, historySize - numSamples), numSamples);
+        decimationFilters[(size_t) channel].process(decimationCoefficients, scratch, (size_t) numSamples);
 
-        juce::FloatVectorOperations::copy(
-            monoBuffer.getWritePointer(0,0),
-            monoBuffer.getReadPointer(0, size),
-            monoBuffer.getNumSamples()-size
-            );
+        auto* write = lowBand.makeRoom(channel, numOut);
+        for (int i = 0; i < numOut; ++i)
+            write[i] = scratch[decimationPhase + i * decimationFactor];
+    }
 
-        juce::FloatVectorOperations::copy(
-            monoBuffer.getWritePointer(0, monoBuffer.getNumSamples()-size),
-            tempIncomingBuffer.getReadPointer(0,0),
-            size
-        );
+    decimationPhase += numOut * decimationFactor - numSamples;
+    lowBand.samplesAdded(numOut, numOut);
+}
 
-        leftChannelFFTDataGenerator.produceFFTDataForRendering(monoBuffer, -48.f);
+void PathProducer::process(const Settings& currentSettings)
+{
+    // the history keeps every sample a window of any size needs, so the new resolution is
+    // analysed as soon as enough audio has come in, and the old path stays up until then
+    if (currentSettings.order != fullBand.fftDataGenerator.getOrder())
+    {
+        fullBand.changeOrder(currentSettings.order);
+        lowBand.changeOrder(currentSettings.order);
     }
 
-    // if there are fft data buffers to pull, if we can pull a buffer => generate a path
-    const auto fftSize = leftChannelFFTDataGenerator.getFFTSize();
-    const auto binWidth = sampleRate / double(fftSize);
+    if (currentSettings.sampleRate != decimationSampleRate)
+        prepareDecimation(currentSettings.sampleRate);
+
+    // the low band isn't fed while it's off, it starts from scratch when it's back
+    if (currentSettings.multiResolution && ! multiResolutionWasOn)
+        resetLowBand();
+    multiResolutionWasOn = currentSettings.multiResolution;
+
+    // max hold starts over every time it's switched on
+    if (currentSettings.maxHold && ! maxHoldWasOn)
+        for (auto* band : { &fullBand, &lowBand })
+            for (auto& b : band->ballistics)
+                b.resetMaxHold(negativeInfinity);
+    maxHoldWasOn = currentSettings.maxHold;
+
+    const auto historySize = fullBand.history.getNumSamples();
+
+    int available = 0, size = 0, overflowed = 0;
 
-    while (leftChannelFFTDataGenerator.getNumAvailableFFTDataBlocks() )
     {
-        std::vector<float> fftData;
-        if (leftChannelFFTDataGenerator.getFFTData(fftData))
+        // prepareToPlay may rebuild the rings at any time, it waits for these to close first
+        std::array<Ring, 2> rings { Ring(*channelFifos[0]), Ring(*channelFifos[1]) };
+        if (! (rings[0].isValid() && rings[1].isValid()))
+            return;
+
+        // both rings are written together, taking the same count from each keeps them in step
+        available = juce::jmin(rings[0].getNumSamplesAvailable(),
+                               rings[1].getNumSamplesAvailable());
+
+        // both rings overflow together, so either one's count is how much audio never made it here.
+        // it still counts as time gone by, the hops it spans show up as frames the fft stage dropped
+        overflowed = juce::jmax(rings[0].takeNumDroppedSamples(), rings[1].takeNumDroppedSamples());
+        profiler.addDroppedSamples(overflowed);
+
+        if (available == 0)
         {
-            pathProducer.generatePath(fftData, fftBounds, fftSize, binWidth, -48.f);
+            fullBand.samplesAdded(0, overflowed);
+            return;
+        }
+
+        // only the newest history can make it to the screen: anything older than that is dropped
+        // unread, the rest slides into the history in one go
+        const auto dropped = juce::jmax(0, available - historySize);
+        size = available - dropped;
+
+        for (int channel = 0; channel < 2; ++channel)
+        {
+            auto& ring = rings[(size_t) channel];
+            ring.read(dropped, [](const float*, int) {});
+
+            // straight out of the ring into the end of the history
+            auto* write = fullBand.makeRoom(channel, size);
+            ring.read(size, [&write](const float* data, int numSamples)
+            {
+                juce::FloatVectorOperations::copy(write, data, numSamples);
+                write += numSamples;
+            });
         }
     }
 
-    // while there are paths that can be pulled, pull as many as we because we only display the most recent path
-    while (pathProducer.getNumPathsAvailable())
+    fullBand.samplesAdded(size, available + overflowed);
+
+    bool analysed = fullBand.analyse(currentSettings, currentSettings.sampleRate, profiler);
+
+    if (currentSettings.multiResolution)
     {
-        pathProducer.getPath(leftChannelFFTPath);
+        decimate(size);
+
+        if (lowBand.analyse(currentSettings, currentSettings.sampleRate / decimationFactor, profiler))
+            analysed = true;
     }
 
+    if (analysed)
+    {
+        generatePaths(currentSettings);
+        newData = true;
+    }
 }
 
-void ResponseCurveComponent::timerCallback()
+void PathProducer::generatePaths(const Settings& currentSettings)
 {
-    if (shouldShowFFTAnalysis)
+    const PipelineProfiler::ScopedTimer timer(profiler, PipelineProfiler::Stage::traces);
+
+    const auto useLowBand = currentSettings.multiResolution && lowBand.hasFrame;
+
+    // the low band up to the crossover, if it has anything yet, the full band above
+    std::array<SpectrumSource, FrequencyPixelMap::maxSources> sources;
+    auto makeSources = [&](auto getData)
     {
-        auto fftBounds = getAnalysisArea().toFloat();
-        auto sampleRate = processorRef.getSampleRate();
+        int numSources = 0;
+
+        if (useLowBand)
+            sources[(size_t) numSources++] = { getData(lowBand), lowBand.fftDataGenerator.getFFTSize(),
+                                               currentSettings.sampleRate / decimationFactor, crossoverFrequency };
 
-        leftPathProducer.process(fftBounds, sampleRate);
-        rightPathProducer.process(fftBounds, sampleRate);
+        sources[(size_t) numSources++] = { getData(fullBand), fullBand.fftDataGenerator.getFFTSize(), currentSettings.sampleRate };
+        return numSources;
+    };
+
+    if (currentSettings.spectrogram)
+    {
+        // the mid signal, i.e. what the mono sum sounds like
+        const auto mid = static_cast<size_t>(Spectrum::mid);
+        const auto numSources = makeSources([mid](const Band& band) { return band.ballistics[mid].getAveraged(); });
+
+        if (! spectrogramRowProducer.generateRow(sources.data(), numSources, (int) currentSettings.fftBounds.getWidth(),
+                                                 currentSettings.reduction, negativeInfinity))
+            profiler.addDropped(PipelineProfiler::Stage::traces);
+        return;
     }
 
-    if (parametersChanged.compareAndSetBool(false, true))
+    auto generate = [&](AnalyzerTraceGenerator& producer, auto getData, float bottomValue, float topValue)
     {
-        // update monochain from apvts
-        updateChain();
+        const auto numSources = makeSources(getData);
+        producer.generateTrace(sources.data(), numSources, currentSettings.fftBounds, currentSettings.reduction,
+                               bottomValue, topValue);
+    };
 
-        // signal a repaint so new response curve is drawn
-        // repaint();
+    // only the pair on screen gets paths
+    const auto first = currentSettings.midSide ? Spectrum::mid : Spectrum::left;
+
+    for (auto s : { static_cast<size_t>(first), static_cast<size_t>(first) + 1 })
+    {
+        auto& producers = traceProducers[s];
+
+        generate(producers[(size_t) Trace::spectrum], [s](const Band& band) { return band.ballistics[s].getAveraged(); },
+                 negativeInfinity, 0.f);
+
+        if (currentSettings.peakHold)
+            generate(producers[(size_t) Trace::peakHold], [s](const Band& band) { return band.ballistics[s].getPeak(); },
+                     negativeInfinity, 0.f);
+        if (currentSettings.maxHold)
+            generate(producers[(size_t) Trace::maxHold], [s](const Band& band) { return band.ballistics[s].getMaxHold(); },
+                     negativeInfinity, 0.f);
     }
-    repaint();
+
+    if (currentSettings.correlation)
+        generate(correlationTraceProducer, [](const Band& band) { return band.correlation.getCorrelation(); }, -1.f, 1.f);
 }
 
-void ResponseCurveComponent::updateChain()
+int PathProducer::useTimeSlice()
 {
-    auto chainSettings = getChainSettings(processorRef.apvts);
+    Settings currentSettings;
+
+    {
+        const juce::SpinLock::ScopedLockType sl(settingsLock);
+        currentSettings = settings;
+    }
 
-    monoChain.setBypassed<ChainPositions::LowCut>(chainSettings.lowCutBypassed);
-    monoChain.setBypassed<ChainPositions::HighCut>(chainSettings.highCutBypassed);
-    monoChain.setBypassed<ChainPositions::Peak>(chainSettings.peakBypassed);
+    if (! currentSettings.active || currentSettings.fftBounds.isEmpty() || currentSettings.sampleRate <= 0)
+    {
+        capturing = false;
+        return 50;
+    }
 
-    auto peakCoefficients = makePeakFilter(chainSettings, processorRef.getSampleRate());
-    updateCoefficients(monoChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
+    if (! capturing)
+    {
+        resync();
+        capturing = true;
+    }
 
-    auto lowCutCoefficients = makeLowCutFilter(chainSettings, processorRef.getSampleRate());
-    auto highCutCoefficients = makeHighCutFilter(chainSettings, processorRef.getSampleRate());
+    process(currentSettings);
 
-    updateCutFilter(monoChain.get<ChainPositions::LowCut>(), lowCutCoefficients, chainSettings.lowCutSlope);
-    updateCutFilter(monoChain.get<ChainPositions::HighCut>(), highCutCoefficients, chainSettings.highCutSlope);
+    // about once per displayed frame
+    return 1000 / 60;
 }
 
-void ResponseCurveComponent::paint (juce::Graphics& g)
+void PathProducer::resync()
 {
-    // (Our component is opaque, so we must completely fill the background with a solid colour)
-    using namespace juce;
-    g.fillAll (Colours::black);
+    // whatever is still in the rings was captured before the analyzer was switched off, or by
+    // another editor. start from the audio that comes in from now on
+    for (auto* fifo : channelFifos)
+    {
+        Ring ring(*fifo);
+        ring.read(ring.getNumSamplesAvailable(), [](const float*, int) {});
+        ring.takeNumDroppedSamples();
+    }
 
-    // draw background
-    g.drawImage(background, getLocalBounds().toFloat());
+    fullBand.reset();
+    resetLowBand();
+}
 
-    auto responseArea = getAnalysisArea();
+bool PathProducer::pullNewData()
+{
+    return newData.exchange(false);
+}
+
+void PathProducer::setSettings(const Settings& newSettings)
+{
+    const juce::SpinLock::ScopedLockType sl(settingsLock);
+    settings = newSettings;
+}
 
-    auto w = responseArea.getWidth();
+const AnalyzerTrace& PathProducer::getTrace(Spectrum spectrum, Trace trace)
+{
+    jassert(static_cast<int>(spectrum) < numDecibelSpectra);
 
-    auto& lowcut = monoChain.get<ChainPositions::LowCut>();
-    auto& peak = monoChain.get<ChainPositions::Peak>();
-    auto& highcut = monoChain.get<ChainPositions::HighCut>();
+    return traceProducers[(size_t) spectrum][(size_t) trace].getLatestTrace();
+}
 
-    auto sampleRate = processorRef.getSampleRate();
+void PathProducer::updateSpectrogram(SpectrogramImage& image, int height)
+{
+    spectrogramRowProducer.readRows([&image, height](const juce::PixelARGB* row, int width)
+    {
+        image.addRow(row, width, height);
+    });
+}
 
-    std::vector<double> magnitudes;
+void SpectrogramImage::addRow(const juce::PixelARGB* row, int width, int height)
+{
+    if (width <= 0 || height <= 0)
+        return;
 
-    magnitudes.resize(w);
-    for (int i = 0; i < w; i++)
+    // starts out transparent, the grid shows until the rows have come in
+    if (image.getWidth() != width || image.getHeight() != height)
     {
-        double magnitude = 1.f;
-        auto freq = juce::mapToLog10(double(i) / double(w), 20.0, 20000.0);
+        image = juce::Image(juce::Image::ARGB, width, height, true);
+        newestRow = 0;
+    }
 
-        if (! monoChain.isBypassed<ChainPositions::Peak>())
-            magnitude *= peak.coefficients->getMagnitudeForFrequency(freq, sampleRate);
+    newestRow = (newestRow + height - 1) % height;
+
+    juce::Image::BitmapData bitmap(image, 0, newestRow, width, 1, juce::Image::BitmapData::writeOnly);
+    for (int x = 0; x < width; ++x)
+        *reinterpret_cast<juce::PixelARGB*>(bitmap.getPixelPointer(x, 0)) = row[x];
+}
 
-        if (!monoChain.isBypassed<ChainPositions::LowCut>())
+void SpectrogramImage::draw(juce::Graphics& g, juce::Rectangle<int> area) const
+{
+    if (image.isNull())
+        return;
+
+    const auto width = image.getWidth();
+    const auto height = image.getHeight();
+
+    // the newest row down to the bottom of the image goes at the top, the rest of the ring below it
+    const auto numNewest = height - newestRow;
+    g.drawImage(image, area.getX(), area.getY(), area.getWidth(), numNewest, 0, newestRow, width, numNewest);
+
+    if (newestRow > 0)
+        g.drawImage(image, area.getX(), area.getY() + numNewest, area.getWidth(), newestRow, 0, 0, width, newestRow);
+}
+
+const AnalyzerTrace& PathProducer::getCorrelationTrace()
+{
+    return correlationTraceProducer.getLatestTrace();
+}
+
+void ResponseCurveComponent::timerCallback()
+{
+    // the analyzer thread does the work, it only needs to know where, how & whether to draw
+    PathProducer::Settings analysisSettings;
+    analysisSettings.fftBounds = getAnalysisArea().toFloat();
+    analysisSettings.sampleRate = processorRef.getSampleRate();
+    analysisSettings.overlap = analyserOverlaps[(size_t) juce::jlimit(0, (int) analyserOverlaps.size() - 1,
+                                                                      (int) analyserParams.overlap->load())];
+    analysisSettings.order = static_cast<FFTOrder>(analyserFFTOrders[(size_t) juce::jlimit(0, (int) analyserFFTOrders.size() - 1,
+                                                                                            (int) analyserParams.resolution->load())]);
+    analysisSettings.averagingTime = analyserAveragingTimes[(size_t) juce::jlimit(0, (int) analyserAveragingTimes.size() - 1,
+                                                                                  (int) analyserParams.averaging->load())];
+    analysisSettings.peakDecayPerSecond = analyserPeakDecayRates[(size_t) juce::jlimit(0, (int) analyserPeakDecayRates.size() - 1,
+                                                                                       (int) analyserParams.peakDecay->load())];
+    analysisSettings.peakHold = analyserParams.peakHold->load() > 0.5f;
+    analysisSettings.maxHold = analyserParams.maxHold->load() > 0.5f;
+    analysisSettings.midSide = analyserParams.mode->load() > 0.5f;
+    analysisSettings.correlation = analyserParams.correlation->load() > 0.5f;
+    analysisSettings.multiResolution = analyserParams.multiResolution->load() > 0.5f;
+    analysisSettings.spectrogram = analyserParams.display->load() > 0.5f;
+    analysisSettings.reduction = analyserParams.binReduction->load() > 0.5f ? BinReduction::average : BinReduction::max;
+    // follows the parameter, which is also what the audio thread goes by
+    analysisSettings.active = analyserParams.enabled->load() > 0.5f;
+
+    // what's drawn changes even before the analyzer delivers anything for it
+    const auto displayChanged = analysisSettings.active != shouldShowFFTAnalysis
+                             || analysisSettings.peakHold != showPeakHold
+                             || analysisSettings.maxHold != showMaxHold
+                             || analysisSettings.midSide != showMidSide
+                             || analysisSettings.correlation != showCorrelation
+                             || analysisSettings.spectrogram != showSpectrogram;
+
+    shouldShowFFTAnalysis = analysisSettings.active;
+    showPeakHold = analysisSettings.peakHold;
+    showMaxHold = analysisSettings.maxHold;
+    showMidSide = analysisSettings.midSide;
+    showCorrelation = analysisSettings.correlation;
+    showSpectrogram = analysisSettings.spectrogram;
+
+    pathProducer.setSettings(analysisSettings);
+
+    // the curve is cached, only re-evaluated when a band, the area or the rate changed
+    const auto curveChanged = parametersChanged.compareAndSetBool(false, true)
+                           || processorRef.getFilterSampleRate() != curveSampleRate
+                           || getAnalysisArea() != curveArea;
+    if (curveChanged)
+    {
+        updateResponseCurve();
+    }
+
+    // nothing new, nothing to draw. the grid is in 'background', so only the render area (with
+    // the curve, the analyzer & the border around them) ever needs painting again
+    const auto newAnalyzerData = pathProducer.pullNewData() && shouldShowFFTAnalysis;
+    if (curveChanged || displayChanged || newAnalyzerData)
+    {
+        repaint(getRenderArea().expanded(2));
+    }
+}
+
+void ResponseCurveComponent::updateResponseCurve()
+{
+    const PipelineProfiler::ScopedTimer timer(profiler, PipelineProfiler::Stage::responseCurve);
+
+    const auto chainSettings = getChainSettings(processorRef.apvts);
+    // the rate the processor designs at, so 2x / 4x show the shapes that are actually heard
+    const auto sampleRate = processorRef.getFilterSampleRate();
+    const auto area = getAnalysisArea();
+    const auto width = area.getWidth();
+
+    // nothing to draw yet. remembered all the same, or every tick would see a change and try again
+    if (width <= 0 || sampleRate <= 0)
+    {
+        responseCurve.clear();
+        curveArea = area;
+        curveSampleRate = sampleRate;
+        return;
+    }
+
+    const auto layoutChanged = area != curveArea || sampleRate != curveSampleRate;
+
+    if (layoutChanged)
+    {
+        for (auto& curve : bandMagnitudes)
+            curve.resize((size_t) width);
+
+        magnitudes.resize((size_t) width);
+        curveResponse.prepareLogarithmic(20.0, 20000.0, width, sampleRate);
+    }
+
+    // dB of one band at every pixel, 0 dB while it's bypassed
+    auto evaluate = [&](ChainPositions band, bool bypassed, auto addSections)
+    {
+        auto& curve = bandMagnitudes[(size_t) band];
+
+        if (bypassed)
         {
-            if (! lowcut.isBypassed<0>())
-                magnitude *= lowcut.get<0>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            if (! lowcut.isBypassed<1>())
-                magnitude *= lowcut.get<1>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            if (! lowcut.isBypassed<2>())
-                magnitude *= lowcut.get<2>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            if (! lowcut.isBypassed<3>())
-                magnitude *= lowcut.get<3>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
+            juce::FloatVectorOperations::clear(curve.data(), width);
+            return;
         }
 
-        if (!monoChain.isBypassed<ChainPositions::HighCut>())
+        CascadeCoefficients<double> cascade;
+        addSections(cascade);
+
+        FrequencyResponse::Result result;
+        result.decibels = curve.data();
+        curveResponse.evaluate(cascade, result);
+    };
+
+    auto addCut = [](CascadeCoefficients<double>& cascade, const CutCoefficients& sections, Slope slope)
+    {
+        for (int i = 0; i < getNumCutSections(slope); ++i)
+            cascade.add(sections[(size_t) i]);
+    };
+
+    // only the bands whose settings changed
+    if (layoutChanged || chainSettings.lowCutBypassed != curveSettings.lowCutBypassed
+        || chainSettings.lowCutFreq != curveSettings.lowCutFreq || chainSettings.lowCutSlope != curveSettings.lowCutSlope)
+    {
+        evaluate(ChainPositions::LowCut, chainSettings.lowCutBypassed, [&](CascadeCoefficients<double>& cascade)
         {
-            if (! highcut.isBypassed<0>())
-                magnitude *= highcut.get<0>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            if (! highcut.isBypassed<1>())
-                magnitude *= highcut.get<1>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            if (! highcut.isBypassed<2>())
-                magnitude *= highcut.get<2>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            if (! highcut.isBypassed<3>())
-                magnitude *= highcut.get<3>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        }
-            magnitudes[i] = Decibels::gainToDecibels(magnitude);
+            addCut(cascade, makeLowCutFilter(chainSettings, sampleRate), chainSettings.lowCutSlope);
+        });
+    }
+
+    if (layoutChanged || chainSettings.peakBypassed != curveSettings.peakBypassed
+        || chainSettings.peakFreq != curveSettings.peakFreq || chainSettings.peakGainInDecibels != curveSettings.peakGainInDecibels
+        || chainSettings.peakQuality != curveSettings.peakQuality)
+    {
+        evaluate(ChainPositions::Peak, chainSettings.peakBypassed, [&](CascadeCoefficients<double>& cascade)
+        {
+            cascade.add(makePeakFilter(chainSettings, sampleRate));
+        });
+    }
 
+    if (layoutChanged || chainSettings.highCutBypassed != curveSettings.highCutBypassed
+        || chainSettings.highCutFreq != curveSettings.highCutFreq || chainSettings.highCutSlope != curveSettings.highCutSlope)
+    {
+        evaluate(ChainPositions::HighCut, chainSettings.highCutBypassed, [&](CascadeCoefficients<double>& cascade)
+        {
+            addCut(cascade, makeHighCutFilter(chainSettings, sampleRate), chainSettings.highCutSlope);
+        });
     }
 
-    Path responseCurve;
+    curveSettings = chainSettings;
+    curveArea = area;
+    curveSampleRate = sampleRate;
+
+    // the bands multiply, so their dB add up
+    juce::FloatVectorOperations::add(magnitudes.data(),
+                                     bandMagnitudes[ChainPositions::LowCut].data(),
+                                     bandMagnitudes[ChainPositions::Peak].data(),
+                                     width);
+    juce::FloatVectorOperations::add(magnitudes.data(), bandMagnitudes[ChainPositions::HighCut].data(), width);
 
-    const double outputMin = responseArea.getBottom();
-    const double outputMax = responseArea.getY();
-    auto map = [outputMin, outputMax](double input)
+    const auto outputMin = (float) area.getBottom();
+    const auto outputMax = (float) area.getY();
+    auto map = [outputMin, outputMax](float input)
     {
-        return jmap(input, -24.0, 24.0, outputMin, outputMax);
+        return juce::jmap(input, -24.f, 24.f, outputMin, outputMax);
     };
 
-    responseCurve.startNewSubPath(responseArea.getX(), map(magnitudes.front()));
+    responseCurve.clear();
+    responseCurve.preallocateSpace(3 * width);
+    responseCurve.startNewSubPath((float) area.getX(), map(magnitudes.front()));
 
     // create lineto for every other magnitude
-    for (size_t i = 1; i < magnitudes.size(); i++)
+    for (int i = 1; i < width; i++)
     {
-        responseCurve.lineTo(responseArea.getX() + i, map(magnitudes[i]));
+        responseCurve.lineTo((float) (area.getX() + i), map(magnitudes[(size_t) i]));
     }
+}
+
+void ResponseCurveComponent::paint (juce::Graphics& g)
+{
+    const PipelineProfiler::ScopedTimer timer(profiler, PipelineProfiler::Stage::paint);
 
-    if (shouldShowFFTAnalysis)
+    // (Our component is opaque, so we must completely fill the background with a solid colour)
+    using namespace juce;
+    g.fillAll (Colours::black);
+
+    // draw background: the grid & labels, cached in resized(). a plain blit of the dirty region
+    g.drawImageAt(background, 0, 0);
+
+    auto responseArea = getAnalysisArea();
+
+    if (shouldShowFFTAnalysis && showSpectrogram)
+    {
+        pathProducer.updateSpectrogram(spectrogramImage, responseArea.getHeight());
+        spectrogramImage.draw(g, responseArea);
+    }
+    else if (shouldShowFFTAnalysis)
     {
-        auto leftChannelFFTPath = leftPathProducer.getPath();
-        leftChannelFFTPath.applyTransform(AffineTransform().translation(responseArea.getX(), responseArea.getY()));
-        g.setColour(Colours::cornflowerblue);
-        g.strokePath(leftChannelFFTPath, PathStrokeType(1));
+        // left & right, or mid & side, in the same colours
+        const auto first = showMidSide ? Spectrum::mid : Spectrum::left;
+        const auto second = showMidSide ? Spectrum::side : Spectrum::right;
+
+        auto drawTrace = [&](PathProducer::Trace trace, float alpha)
+        {
+            strokeTrace(g, pathProducer.getTrace(first, trace), Colours::cornflowerblue.withAlpha(alpha));
+            strokeTrace(g, pathProducer.getTrace(second, trace), Colours::palegoldenrod.withAlpha(alpha));
+        };
+
+        if (showCorrelation)
+            strokeTrace(g, pathProducer.getCorrelationTrace(), Colours::mediumseagreen.withAlpha(0.7f));
 
-        auto rightChannelFFTPath = rightPathProducer.getPath();
-        rightChannelFFTPath.applyTransform(AffineTransform().translation(responseArea.getX(), responseArea.getY()));
-        g.setColour(Colours::palegoldenrod);
-        g.strokePath(rightChannelFFTPath, PathStrokeType(1));
+        // hold traces go underneath the live spectrum
+        if (showMaxHold)
+            drawTrace(PathProducer::Trace::maxHold, 0.3f);
+
+        if (showPeakHold)
+            drawTrace(PathProducer::Trace::peakHold, 0.5f);
+
+        drawTrace(PathProducer::Trace::spectrum, 1.f);
     }
 
 
@@ -426,6 +927,22 @@ void ResponseCurveComponent::paint (juce::Graphics& g)
     g.strokePath(responseCurve, PathStrokeType(2.f));
 }
 
+void ResponseCurveComponent::strokeTrace(juce::Graphics& g, const AnalyzerTrace& trace, juce::Colour colour)
+{
+    if (trace.numPoints < 2)
+        return;
+
+    // already in component coordinates
+    tracePath.clear();
+    tracePath.startNewSubPath(trace.x, trace.y.front());
+
+    for (int i = 1; i < trace.numPoints; ++i)
+        tracePath.lineTo(trace.x + (float) i, trace.y[(size_t) i]);
+
+    g.setColour(colour);
+    g.strokePath(tracePath, juce::PathStrokeType(1));
+}
+
 void ResponseCurveComponent::resized()
 {
     using namespace juce;
@@ -547,7 +1064,10 @@ void ResponseCurveComponent::resized()
 
     }
 
+    tracePath.preallocateSpace(3 * getWidth());
 
+    // the curve follows the analysis area
+    updateResponseCurve();
 }
 
 juce::Rectangle<int> ResponseCurveComponent::getRenderArea()
@@ -569,6 +1089,68 @@ juce::Rectangle<int> ResponseCurveComponent::getAnalysisArea()
     return bounds;
 }
 
+//==============================================================================
+ProfilerOverlay::ProfilerOverlay(PipelineProfiler& profilerToShow) :
+profiler(profilerToShow)
+{
+    // it only shows numbers, the response curve underneath still gets the mouse
+    setInterceptsMouseClicks(false, false);
+}
+
+ProfilerOverlay::~ProfilerOverlay()
+{
+    profiler.setEnabled(false);
+}
+
+void ProfilerOverlay::visibilityChanged()
+{
+    // nothing is timed while no one's looking
+    profiler.setEnabled(isVisible());
+
+    if (isVisible())
+        startTimerHz(4);
+    else
+        stopTimer();
+}
+
+void ProfilerOverlay::paint(juce::Graphics& g)
+{
+    using namespace juce;
+
+    g.setColour(Colours::black.withAlpha(0.75f));
+    g.fillRoundedRectangle(getLocalBounds().toFloat(), 4.f);
+
+    g.setColour(Colours::white);
+    g.setFont(Font(Font::getDefaultMonospacedFontName(), 11.f, Font::plain));
+
+    const auto stats = profiler.getStats();
+    const auto lineHeight = 14;
+    auto area = getLocalBounds().reduced(6, 4);
+
+    auto drawLine = [&](const String& text)
+    {
+        g.drawSingleLineText(text, area.getX(), area.getY() + lineHeight - 3);
+        area.removeFromTop(lineHeight);
+    };
+
+    auto column = [](const String& text, int width) { return text.paddedRight(' ', width); };
+    auto ms = [](double value) { return String(value, 2).paddedLeft(' ', 6); };
+
+    drawLine(column("ms", 15) + "   min   mean    p99  dropped");
+
+    for (int s = 0; s < PipelineProfiler::numStages; ++s)
+    {
+        const auto stage = static_cast<PipelineProfiler::Stage>(s);
+        const auto& stageStats = stats[stage];
+
+        drawLine(column(PipelineProfiler::getStageName(stage), 15)
+                 + ms(stageStats.minMs) + " " + ms(stageStats.meanMs) + " " + ms(stageStats.p99Ms)
+                 + String(stageStats.numDropped).paddedLeft(' ', 9));
+    }
+
+    drawLine(column("audio fifos", 15) + String(stats.numDroppedSamples) + " samples dropped");
+}
+
 //==============================================================================
 SimpleEQAudioProcessorEditor::SimpleEQAudioProcessorEditor (SimpleEQAudioProcessor& p)
     : AudioProcessorEditor (&p), processorRef (p),
@@ -580,6 +1162,7 @@ highCutFreqSlider(*processorRef.apvts.getParameter("HighCut Freq"), "Hz"),
 lowCutSlopeSlider(*processorRef.apvts.getParameter("LowCut Slope"), "dB/Oct"),
 highCutSlopeSlider(*processorRef.apvts.getParameter("HighCut Slope"), "dB/Oct"),
 responseCurveComponent(processorRef),
+profilerOverlay(responseCurveComponent.getProfiler()),
 
 peakFreqSliderAttachment(processorRef.apvts, "Peak Freq", peakFreqSlider),
 peakGainSliderAttachment(processorRef.apvts, "Peak Gain", peakGainSlider),
@@ -589,10 +1172,35 @@ highCutFreqSliderAttachment(processorRef.apvts, "HighCut Freq", highCutFreqSlide
 lowCutSlopeSliderAttachment(processorRef.apvts, "LowCut Slope", lowCutSlopeSlider),
 highCutSlopeSliderAttachment(processorRef.apvts, "HighCut Slope", highCutSlopeSlider),
 
+oversamplingBox(*processorRef.apvts.getParameter("Oversampling"), "Oversampling"),
+linearPhasePartitionBox(*processorRef.apvts.getParameter("Linear Phase Partition"), "Partition"),
+analyserResolutionBox(*processorRef.apvts.getParameter("Analyser Resolution"), "FFT"),
+analyserOverlapBox(*processorRef.apvts.getParameter("Analyser Overlap"), "Overlap"),
+analyserAveragingBox(*processorRef.apvts.getParameter("Analyser Averaging"), "Avg"),
+analyserBinReductionBox(*processorRef.apvts.getParameter("Analyser Bin Reduction"), "Bins"),
+analyserPeakDecayBox(*processorRef.apvts.getParameter("Analyser Peak Decay"), "Decay"),
+analyserModeBox(*processorRef.apvts.getParameter("Analyser Mode")),
+analyserDisplayBox(*processorRef.apvts.getParameter("Analyser Display")),
+
 lowcutBypassButtonAttachment(processorRef.apvts, "LowCut Bypassed", lowcutBypassButton),
 highcutBypassButtonAttachment(processorRef.apvts, "HighCut Bypassed", highcutBypassButton),
 peakBypassButtonAttachment(processorRef.apvts, "Peak Bypassed", peakBypassButton),
-analyserEnabledButtonAttachment(processorRef.apvts, "Analyser Enabled", analyserEnabledButton)
+analyserEnabledButtonAttachment(processorRef.apvts, "Analyser Enabled", analyserEnabledButton),
+linearPhaseButtonAttachment(processorRef.apvts, "Linear Phase", linearPhaseButton),
+analyserPeakHoldButtonAttachment(processorRef.apvts, "Analyser Peak Hold", analyserPeakHoldButton),
+analyserMaxHoldButtonAttachment(processorRef.apvts, "Analyser Max Hold", analyserMaxHoldButton),
+analyserCorrelationButtonAttachment(processorRef.apvts, "Analyser Correlation", analyserCorrelationButton),
+analyserMultiResolutionButtonAttachment(processorRef.apvts, "Analyser Multi-Resolution", analyserMultiResolutionButton),
+
+oversamplingBoxAttachment(processorRef.apvts, "Oversampling", oversamplingBox),
+linearPhasePartitionBoxAttachment(processorRef.apvts, "Linear Phase Partition", linearPhasePartitionBox),
+analyserResolutionBoxAttachment(processorRef.apvts, "Analyser Resolution", analyserResolutionBox),
+analyserOverlapBoxAttachment(processorRef.apvts, "Analyser Overlap", analyserOverlapBox),
+analyserAveragingBoxAttachment(processorRef.apvts, "Analyser Averaging", analyserAveragingBox),
+analyserBinReductionBoxAttachment(processorRef.apvts, "Analyser Bin Reduction", analyserBinReductionBox),
+analyserPeakDecayBoxAttachment(processorRef.apvts, "Analyser Peak Decay", analyserPeakDecayBox),
+analyserModeBoxAttachment(processorRef.apvts, "Analyser Mode", analyserModeBox),
+analyserDisplayBoxAttachment(processorRef.apvts, "Analyser Display", analyserDisplayBox)
 {
     // Make sure that before the constructor has finished, you've set the
     // editor's size to whatever you need it to be.
@@ -624,6 +1232,10 @@ analyserEnabledButtonAttachment(processorRef.apvts, "Analyser Enabled", analyser
         addAndMakeVisible(comp);
     }
 
+    // on top of everything, hidden until asked for
+    addChildComponent(profilerOverlay);
+    setWantsKeyboardFocus(true);
+
     peakBypassButton.setLookAndFeel(&lnf);
     lowcutBypassButton.setLookAndFeel(&lnf);
     highcutBypassButton.setLookAndFeel(&lnf);
@@ -667,10 +1279,26 @@ analyserEnabledButtonAttachment(processorRef.apvts, "Analyser Enabled", analyser
       {
           auto enabled = comp->analyserEnabledButton.getToggleState();
           comp->responseCurveComponent.toggleAnalysisEnablement(enabled);
+          comp->updateAnalyserControls();
       }
     };
 
-    setSize (600, 400);
+    profilerButton.onClick = [safePtr] ()
+    {
+        if (auto* comp = safePtr.getComponent())
+            comp->setProfilerOverlayVisible(comp->profilerButton.getToggleState());
+    };
+
+    linearPhaseButton.onClick = [safePtr] ()
+    {
+        if (auto* comp = safePtr.getComponent())
+            comp->updateProcessingModeControls();
+    };
+
+    updateProcessingModeControls();
+    updateAnalyserControls();
+
+    setSize (600, 450);
 }
 
     SimpleEQAudioProcessorEditor::~SimpleEQAudioProcessorEditor()
@@ -698,12 +1326,45 @@ analyserEnabledButtonAttachment(processorRef.apvts, "Analyser Enabled", analyser
         // Bottom 2/3 is sliders
         auto bounds = getLocalBounds();
 
-        auto analyserEnabledArea = bounds.removeFromTop(25);
+        auto topArea = bounds.removeFromTop(25);
+
+        auto analyserEnabledArea = topArea;
         analyserEnabledArea.setWidth(100);
         analyserEnabledArea.setX(5);
         analyserEnabledArea.removeFromTop(2);
 
         analyserEnabledButton.setBounds(analyserEnabledArea);
+        profilerButton.setBounds(analyserEnabledArea.withX(analyserEnabledArea.getRight() + 5).withWidth(80));
+
+        // processing modes along the right of the same row
+        topArea.removeFromTop(2);
+        topArea.removeFromRight(5);
+        linearPhasePartitionBox.setBounds(topArea.removeFromRight(110));
+        topArea.removeFromRight(5);
+        linearPhaseButton.setBounds(topArea.removeFromRight(100));
+        topArea.removeFromRight(5);
+        oversamplingBox.setBounds(topArea.removeFromRight(120));
+
+        // analyser settings, left to right
+        auto layOutRow = [&bounds](std::initializer_list<std::pair<juce::Component*, int>> comps)
+        {
+            auto row = bounds.removeFromTop(25);
+            row.removeFromTop(2);
+            row.removeFromLeft(5);
+
+            for (const auto& [comp, width] : comps)
+            {
+                comp->setBounds(row.removeFromLeft(width));
+                row.removeFromLeft(5);
+            }
+        };
+
+        layOutRow({ { &analyserResolutionBox, 100 }, { &analyserOverlapBox, 110 },
+                    { &analyserAveragingBox, 110 }, { &analyserBinReductionBox, 100 },
+                    { &analyserPeakDecayBox, 120 } });
+        layOutRow({ { &analyserModeBox, 100 }, { &analyserDisplayBox, 110 },
+                    { &analyserPeakHoldButton, 80 }, { &analyserMaxHoldButton, 75 },
+                    { &analyserCorrelationButton, 90 }, { &analyserMultiResolutionButton, 80 } });
 
         bounds.removeFromTop(5);
 
@@ -711,6 +1372,8 @@ analyserEnabledButtonAttachment(processorRef.apvts, "Analyser Enabled", analyser
         auto responseArea = bounds.removeFromTop(bounds.getHeight() * hRatio);
 
         responseCurveComponent.setBounds(responseArea);
+        profilerOverlay.setBounds(responseCurveComponent.getX() + 24, responseCurveComponent.getY() + 14,
+                                  ProfilerOverlay::preferredWidth, ProfilerOverlay::preferredHeight);
 
         bounds.removeFromTop(5);
 
@@ -731,9 +1394,47 @@ analyserEnabledButtonAttachment(processorRef.apvts, "Analyser Enabled", analyser
         peakQualitySlider.setBounds(bounds);
     }
 
+    bool SimpleEQAudioProcessorEditor::keyPressed(const juce::KeyPress& key)
+    {
+        const auto modifiers = juce::ModifierKeys::commandModifier | juce::ModifierKeys::shiftModifier;
+
+        if (key == juce::KeyPress('p', modifiers, 0))
+        {
+            setProfilerOverlayVisible(! isProfilerOverlayVisible());
+            return true;
+        }
+
+        return false;
+    }
+
+    void SimpleEQAudioProcessorEditor::setProfilerOverlayVisible(bool shouldBeVisible)
+    {
+        profilerOverlay.setVisible(shouldBeVisible);
+        profilerButton.setToggleState(shouldBeVisible, juce::dontSendNotification);
+    }
+
+    PipelineProfiler::Stats SimpleEQAudioProcessorEditor::getProfilerStats() const
+    {
+        return responseCurveComponent.getProfiler().getStats();
+    }
+
+    void SimpleEQAudioProcessorEditor::updateProcessingModeControls()
+    {
+        const auto linearPhase = linearPhaseButton.getToggleState();
+        oversamplingBox.setEnabled(! linearPhase);
+        linearPhasePartitionBox.setEnabled(linearPhase);
+    }
+
+    void SimpleEQAudioProcessorEditor::updateAnalyserControls()
+    {
+        const auto enabled = analyserEnabledButton.getToggleState();
+        for (auto* comp : getAnalyserComps())
+            comp->setEnabled(enabled);
+    }
+
     std::vector<juce::Component*> SimpleEQAudioProcessorEditor::getComps()
     {
-        return {
+        std::vector<juce::Component*> comps {
             &peakFreqSlider,
             &peakGainSlider,
             &peakQualitySlider,
@@ -747,6 +1448,33 @@ analyserEnabledButtonAttachment(processorRef.apvts, "Analyser Enabled", analyser
             &lowcutBypassButton,
             &peakBypassButton,
             &highcutBypassButton,
-            &analyserEnabledButton
+            &analyserEnabledButton,
+            &profilerButton,
+
+            // processing modes
+            &oversamplingBox,
+            &linearPhaseButton,
+            &linearPhasePartitionBox
+        };
+
+        const auto analyserComps = getAnalyserComps();
+        comps.insert(comps.end(), analyserComps.begin(), analyserComps.end());
+        return comps;
+    }
+
+    std::vector<juce::Component*> SimpleEQAudioProcessorEditor::getAnalyserComps()
+    {
+        return {
+            &analyserResolutionBox,
+            &analyserOverlapBox,
+            &analyserAveragingBox,
+            &analyserBinReductionBox,
+            &analyserPeakDecayBox,
+            &analyserModeBox,
+            &analyserDisplayBox,
+            &analyserPeakHoldButton,
+            &analyserMaxHoldButton,
+            &analyserCorrelationButton,
+            &analyserMultiResolutionButton
         };
     }
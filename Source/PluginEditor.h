@@ -1,147 +1,635 @@
 #pragma once
 
 #include "PluginProcessor.h"
+#include "FrequencyResponse.h"
+#include "PipelineProfiler.h"
+#include <cstdint>
+#include <atomic>
+#include <cstring>
+#include <limits>
 
 enum FFTOrder
 {
     order2048 = 11,
     order4096 = 12,
-    order8192 = 13
+    order8192 = 13,
+    maxFFTOrder = order8192
 };
 
+/**
+ in-place gain -> decibels for a whole spectrum. values are scaled & clamped to the floor with
+ FloatVectorOperations, then log2 is approximated from the float's exponent & a polynomial in its
+ mantissa (within 0.002 dB), which unlike std::log10 vectorises.
+ */
+inline void convertToDecibels(float* data, int numValues, float scale, float negativeInfinity)
+{
+    juce::FloatVectorOperations::multiply(data, scale, numValues);
+    juce::FloatVectorOperations::max(data, data, juce::Decibels::decibelsToGain(negativeInfinity), numValues);
+
+    constexpr float decibelsPerOctave = 6.0205999f; // 20 * log10(2)
+
+    for (int i = 0; i < numValues; ++i)
+    {
+        std::int32_t bits;
+        std::memcpy(&bits, data + i, sizeof(bits));
+
+        const auto exponent = float((bits >> 23) - 127);
+        bits = (bits & 0x007fffff) | 0x3f800000;
+
+        float mantissa;
+        std::memcpy(&mantissa, &bits, sizeof(mantissa));
+
+        // least squares fit of log2(1 + t) over [0, 1)
+        const auto t = mantissa - 1.f;
+        const auto log2Mantissa = t * (1.4385468f + t * (-0.6780815f + t * (0.3236304f + t * -0.0842851f)));
+
+        data[i] = decibelsPerOctave * (exponent + log2Mantissa);
+    }
+
+    juce::FloatVectorOperations::max(data, data, negativeInfinity, numValues);
+}
+
+// what one analyzer frame holds, getFFTSize() / 2 values of each, one after the other. the first
+// numDecibelSpectra are magnitudes in dB, the rest are the linear (cross) power spectra behind the
+// inter-channel correlation: Re(L * conj(R)), |L|^2 and |R|^2
+enum class Spectrum
+{
+    left,
+    right,
+    mid,
+    side,
+    crossPower,
+    leftPower,
+    rightPower,
+    numSpectra
+};
+
+constexpr int numDecibelSpectra = static_cast<int>(Spectrum::crossPower);
+
 template<typename BlockType>
 struct FFTDataGenerator
 {
     /**
-     produces the FFT data from an audio buffer.
+     produces the FFT data from the getFFTSize() samples at 'left' & 'right', straight into the next
+     free frame of the pool. when the reader hasn't handed enough frames back, this one is skipped.
+
+     both channels go through a single complex transform, left as the real & right as the imaginary
+     part, and are pulled apart again with the symmetry of a real signal's spectrum. that's one FFT
+     of the same size per frame instead of one per channel.
+
+     false when the frame was skipped.
      */
-    void produceFFTDataForRendering(const juce::AudioBuffer<float>& audioData, const float negativeInfinity)
+    bool produceFFTDataForRendering(const float* left, const float* right, const float negativeInfinity)
     {
         const auto fftSize = getFFTSize();
+        const auto numBins = fftSize / 2;
 
-        fftData.assign(fftData.size(), 0);
-        auto* readIndex = audioData.getReadPointer(0);
-        std::copy(readIndex, readIndex + fftSize, fftData.begin());
+        const auto scope = framePool.write(framePool.getFreeSpace() > 0 ? 1 : 0);
+        if (scope.blockSize1 == 0)
+            return false;
 
-        // first apply a windowing function to our data
-        window->multiplyWithWindowingTable (fftData.data(), fftSize);       // [1]
+        auto* frame = frames[(size_t) scope.startIndex1].data();
 
-        // then render our FFT data..
-        forwardFFT->performFrequencyOnlyForwardTransform (fftData.data());  // [2]
+        // window while packing
+        for (int i = 0; i < fftSize; ++i)
+            packed[(size_t) i] = { left[i] * windowTable[(size_t) i], right[i] * windowTable[(size_t) i] };
 
-        int numBins = (int)fftSize / 2;
+        forwardFFT->perform(packed.data(), transformed.data(), false);
 
-        //normalize the fft values.
-        for( int i = 0; i < numBins; ++i )
-        {
-            fftData[i] /= (float) numBins;
-        }
+        auto spectra = [frame, numBins](Spectrum s) { return frame + static_cast<int>(s) * numBins; };
+        auto* leftMagnitude = spectra(Spectrum::left);
+        auto* rightMagnitude = spectra(Spectrum::right);
+        auto* midMagnitude = spectra(Spectrum::mid);
+        auto* sideMagnitude = spectra(Spectrum::side);
+        auto* crossPower = spectra(Spectrum::crossPower);
+        auto* leftPower = spectra(Spectrum::leftPower);
+        auto* rightPower = spectra(Spectrum::rightPower);
+
+        // normalize the fft values like the magnitudes below
+        const auto powerScale = 1.f / float(numBins * numBins);
 
-        //convert them to decibels
-        for( int i = 0; i < numBins; ++i )
+        for (int k = 0; k < numBins; ++k)
         {
-            fftData[i] = juce::Decibels::gainToDecibels(fftData[i], negativeInfinity);
+            // with Z = FFT(l + i r): L[k] = (Z[k] + conj(Z[N - k])) / 2, R[k] = (Z[k] - conj(Z[N - k])) / 2i
+            const auto z = transformed[(size_t) k];
+            const auto mirrored = std::conj(transformed[(size_t) ((fftSize - k) & (fftSize - 1))]);
+
+            const auto l = (z + mirrored) * 0.5f;
+            const auto r = (z - mirrored) * std::complex<float>(0.f, -0.5f);
+
+            const auto leftNorm = std::norm(l);
+            const auto rightNorm = std::norm(r);
+
+            leftMagnitude[k] = std::sqrt(leftNorm);
+            rightMagnitude[k] = std::sqrt(rightNorm);
+            midMagnitude[k] = std::sqrt(std::norm(l + r)) * 0.5f;
+            sideMagnitude[k] = std::sqrt(std::norm(l - r)) * 0.5f;
+
+            crossPower[k] = (l.real() * r.real() + l.imag() * r.imag()) * powerScale;
+            leftPower[k] = leftNorm * powerScale;
+            rightPower[k] = rightNorm * powerScale;
         }
 
-        fftDataFifo.push(fftData);
+        //normalize the fft values & convert them to decibels, all four magnitude spectra in one go
+        convertToDecibels(leftMagnitude, numDecibelSpectra * numBins, 1.f / (float) numBins, negativeInfinity);
+        return true;
     }
 
     void changeOrder(FFTOrder newOrder)
     {
-        //when you change order, recreate the window, forwardFFT, fifo, fftData
-        //also reset the fifoIndex
-        //things that need recreating should be created on the heap via std::make_unique<>
+        //when you change order, recreate the window, forwardFFT & frames
+        //only from the thread that also produces & reads the frames
 
         order = newOrder;
         auto fftSize = getFFTSize();
 
         forwardFFT = std::make_unique<juce::dsp::FFT>(order);
-        window = std::make_unique<juce::dsp::WindowingFunction<float>>(fftSize, juce::dsp::WindowingFunction<float>::blackmanHarris);
 
-        fftData.clear();
-        fftData.resize(fftSize * 2, 0);
+        windowTable.assign((size_t) fftSize, 0.f);
+        juce::dsp::WindowingFunction<float>::fillWindowingTables(windowTable.data(), (size_t) fftSize,
+                                                                 juce::dsp::WindowingFunction<float>::blackmanHarris);
 
-        fftDataFifo.prepare(fftData.size());
+        packed.assign((size_t) fftSize, {});
+        transformed.assign((size_t) fftSize, {});
+
+        for (auto& frame : frames)
+            frame.assign((size_t) (static_cast<int>(Spectrum::numSpectra) * fftSize / 2), 0.f);
+
+        framePool.reset();
     }
     //==============================================================================
+    FFTOrder getOrder() const { return order; }
     int getFFTSize() const { return 1 << order; }
-    int getNumAvailableFFTDataBlocks() const { return fftDataFifo.getNumAvailableForReading(); }
+    int getNumAvailableFFTDataBlocks() const { return framePool.getNumReady(); }
     //==============================================================================
-    bool getFFTData(BlockType& fftData) { return fftDataFifo.pull(fftData); }
+    // calls consume(const float* frame, int numBins) with the oldest frame, then hands it back to the pool.
+    // 'frame' holds every Spectrum, each numBins long
+    template<typename Consumer>
+    bool getFFTData(Consumer&& consume)
+    {
+        const auto scope = framePool.read(framePool.getNumReady() > 0 ? 1 : 0);
+        if (scope.blockSize1 == 0)
+            return false;
+
+        consume(static_cast<const float*>(frames[(size_t) scope.startIndex1].data()), getFFTSize() / 2);
+        return true;
+    }
 private:
+    static constexpr int numFrames = 8;
+
     FFTOrder order;
-    BlockType fftData;
     std::unique_ptr<juce::dsp::FFT> forwardFFT;
-    std::unique_ptr<juce::dsp::WindowingFunction<float>> window;
+    std::vector<float> windowTable;
+    std::vector<juce::dsp::Complex<float>> packed, transformed;
 
-    Fifo<BlockType> fftDataFifo;
+    // frames are written & read in place, only their indices go through the fifo
+    std::array<BlockType, numFrames> frames;
+    juce::AbstractFifo framePool { numFrames };
 };
 
-template<typename PathType>
-struct AnalyzerPathGenerator
+/**
+ ballistics for the analyzer, run on every new dB spectrum in place over the bin arrays with
+ FloatVectorOperations: exponential averaging, a peak trace that falls back at a fixed rate, and a
+ max trace that only ever rises. all of it per frame, no extra frames are analysed or drawn for it.
+ */
+struct SpectrumBallistics
 {
-    /*
-     converts 'renderData[]' into a juce::Path
-     */
-    void generatePath(const std::vector<float>& renderData,
-                      juce::Rectangle<float> fftBounds,
-                      int fftSize,
-                      float binWidth,
-                      float negativeInfinity)
+    // allocates, reset() before processing
+    void prepare(int maxNumBins)
     {
-        auto top = fftBounds.getY();
-        auto bottom = fftBounds.getHeight();
-        auto width = fftBounds.getWidth();
+        averaged.resize((size_t) maxNumBins);
+        peak.resize((size_t) maxNumBins);
+        maxHold.resize((size_t) maxNumBins);
+    }
+
+    // starts every trace from the floor
+    void reset(int numBinsToUse, float negativeInfinity)
+    {
+        jassert(numBinsToUse <= (int) averaged.size());
+        numBins = numBinsToUse;
+        std::fill(averaged.begin(), averaged.end(), negativeInfinity);
+        std::fill(peak.begin(), peak.end(), negativeInfinity);
+        resetMaxHold(negativeInfinity);
+    }
+
+    void resetMaxHold(float negativeInfinity) { std::fill(maxHold.begin(), maxHold.end(), negativeInfinity); }
+
+    // 'frame' holds getNumBins() dB values, 'seconds' is the audio time since the previous frame
+    void process(const float* frame, double seconds, float averagingTime, float peakDecayPerSecond)
+    {
+        // one pole smoothing with the time constant 'averagingTime', whatever the frame rate
+        const auto coefficient = averagingTime > 0.f ? (float) (1.0 - std::exp(-seconds / averagingTime)) : 1.f;
+
+        juce::FloatVectorOperations::multiply(averaged.data(), 1.f - coefficient, numBins);
+        juce::FloatVectorOperations::addWithMultiply(averaged.data(), frame, coefficient, numBins);
+
+        juce::FloatVectorOperations::add(peak.data(), -peakDecayPerSecond * (float) seconds, numBins);
+        juce::FloatVectorOperations::max(peak.data(), peak.data(), averaged.data(), numBins);
+
+        juce::FloatVectorOperations::max(maxHold.data(), maxHold.data(), averaged.data(), numBins);
+    }
+
+    int getNumBins() const { return numBins; }
+    const float* getAveraged() const { return averaged.data(); }
+    const float* getPeak() const { return peak.data(); }
+    const float* getMaxHold() const { return maxHold.data(); }
+
+private:
+    std::vector<float> averaged, peak, maxHold;
+    int numBins = 0;
+};
 
-        int numBins = (int)fftSize / 2;
+/**
+ inter-channel correlation per bin, Re(L R*) / sqrt(|L|^2 |R|^2): +1 where both channels carry the
+ same signal, 0 where they're unrelated, -1 where one is the other inverted. the cross & auto
+ spectra are averaged over time before dividing, a single frame would only give the cosine of the
+ phase difference.
+ */
+struct CorrelationSpectrum
+{
+    // allocates, reset() before processing
+    void prepare(int maxNumBins)
+    {
+        crossPower.resize((size_t) maxNumBins);
+        leftPower.resize((size_t) maxNumBins);
+        rightPower.resize((size_t) maxNumBins);
+        correlation.resize((size_t) maxNumBins);
+    }
 
-        PathType p;
-        p.preallocateSpace(3 * (int)fftBounds.getWidth());
+    void reset(int numBinsToUse)
+    {
+        jassert(numBinsToUse <= (int) correlation.size());
+        numBins = numBinsToUse;
+        std::fill(crossPower.begin(), crossPower.end(), 0.f);
+        std::fill(leftPower.begin(), leftPower.end(), 0.f);
+        std::fill(rightPower.begin(), rightPower.end(), 0.f);
+        std::fill(correlation.begin(), correlation.end(), 0.f);
+    }
 
-        auto map = [bottom, top, negativeInfinity](float v)
+    // the three linear spectra of one frame, 'seconds' since the previous one. bins where either channel
+    // is below 'negativeInfinity' read as 0
+    void process(const float* cross, const float* left, const float* right,
+                 double seconds, float averagingTime, float negativeInfinity)
+    {
+        // without some averaging there is nothing to correlate
+        const auto time = juce::jmax(averagingTime, minimumAveragingTime);
+        const auto coefficient = (float) (1.0 - std::exp(-seconds / time));
+
+        auto smooth = [this, coefficient](std::vector<float>& average, const float* frame)
         {
-            return juce::jmap(v,
-                              negativeInfinity, 0.f,
-                              float(bottom),   top);
+            juce::FloatVectorOperations::multiply(average.data(), 1.f - coefficient, numBins);
+            juce::FloatVectorOperations::addWithMultiply(average.data(), frame, coefficient, numBins);
         };
 
-        auto y = map(renderData[0]);
+        smooth(crossPower, cross);
+        smooth(leftPower, left);
+        smooth(rightPower, right);
 
-        jassert( !std::isnan(y) && !std::isinf(y) );
+        const auto floorPower = juce::square(juce::Decibels::decibelsToGain(negativeInfinity));
 
-        p.startNewSubPath(0, y);
+        for (int k = 0; k < numBins; ++k)
+        {
+            const auto l = leftPower[(size_t) k];
+            const auto r = rightPower[(size_t) k];
 
-        const int pathResolution = 2; //you can draw line-to's every 'pathResolution' pixels.
+            correlation[(size_t) k] = juce::jmin(l, r) > floorPower
+                                    ? juce::jlimit(-1.f, 1.f, crossPower[(size_t) k] / std::sqrt(l * r))
+                                    : 0.f;
+        }
+    }
+
+    int getNumBins() const { return numBins; }
+    const float* getCorrelation() const { return correlation.data(); }
+
+private:
+    static constexpr float minimumAveragingTime = 0.1f;
 
-        for( int binNum = 1; binNum < numBins; binNum += pathResolution )
+    std::vector<float> crossPower, leftPower, rightPower, correlation;
+    int numBins = 0;
+};
+
+// how the bins that fall into one pixel column are combined
+enum class BinReduction
+{
+    max,
+    average
+};
+
+// one spectrum an analyzer path is drawn from
+struct SpectrumSource
+{
+    const float* data = nullptr;    // fftSize / 2 values
+    int fftSize = 0;
+    double sampleRate = 0;
+    double maxFrequency = std::numeric_limits<double>::max();  // columns from here up come from the next source
+};
+
+/**
+ which source & bins land in each pixel of the log frequency axis (20 Hz - 20 kHz over 'numPixels'),
+ rebuilt only when the size or the sources change. the sources are in order of frequency, each pixel
+ is taken from the first one that reaches above it
+ */
+struct FrequencyPixelMap
+{
+    static constexpr int maxSources = 2;
+
+    void update(int numPixels, const SpectrumSource* sources, int numSources)
+    {
+        jassert(numSources > 0 && numSources <= maxSources);
+
+        std::array<SourceLayout, maxSources> layout;
+        for (int s = 0; s < numSources; ++s)
+            layout[(size_t) s] = { sources[s].fftSize, sources[s].sampleRate, sources[s].maxFrequency };
+
+        if (numPixels == mapNumPixels && numSources == mapNumSources
+            && std::equal(layout.begin(), layout.begin() + numSources, mapLayout.begin()))
+            return;
+
+        mapNumPixels = numPixels;
+        mapNumSources = numSources;
+        mapLayout = layout;
+
+        auto getFrequency = [numPixels](double x) { return juce::mapToLog10(x / double(numPixels), 20.0, 20000.0); };
+
+        pixels.resize((size_t) numPixels);
+        for (int x = 0; x < numPixels; ++x)
         {
-            y = map(renderData[binNum]);
+            auto& pixel = pixels[(size_t) x];
 
-            jassert( !std::isnan(y) && !std::isinf(y) );
+            int s = 0;
+            while (s < numSources - 1 && getFrequency(x + 0.5) >= sources[s].maxFrequency)
+                ++s;
+
+            const auto binWidth = sources[s].sampleRate / double(sources[s].fftSize);
+            const auto numBins = sources[s].fftSize / 2;
+
+            // bins whose centre falls inside [left edge, right edge) of the pixel
+            const auto first = juce::jlimit(0, numBins, (int) std::ceil(getFrequency(x) / binWidth));
+            const auto end = juce::jlimit(first, numBins, (int) std::ceil(getFrequency(x + 1) / binWidth));
 
-            if( !std::isnan(y) && !std::isinf(y) )
+            if (end > first)
             {
-                auto binFreq = binNum * binWidth;
-                auto normalizedBinX = juce::mapFromLog10(binFreq, 20.f, 20000.f);
-                int binX = std::floor(normalizedBinX * width);
-                p.lineTo(binX, y);
+                pixel = { s, first, end - first, 0.f };
+            }
+            else
+            {
+                const auto position = juce::jlimit(0.0, double(numBins - 1), getFrequency(x + 0.5) / binWidth);
+                const auto index = juce::jmin((int) position, numBins - 2);
+                pixel = { s, index, 0, float(position - index) };
             }
         }
+    }
 
-        pathFifo.push(p);
+    // the value of pixel 'x', from the same sources update() was given
+    float getValue(int x, const SpectrumSource* sources, BinReduction reduction) const
+    {
+        const auto& pixel = pixels[(size_t) x];
+        const auto* data = sources[pixel.source].data;
+
+        // narrower than a bin: interpolate at the pixel's centre
+        if (pixel.numBins == 0)
+            return juce::jmap(pixel.fraction, data[pixel.firstBin], data[pixel.firstBin + 1]);
+
+        if (reduction == BinReduction::max)
+            return juce::FloatVectorOperations::findMaximum(data + pixel.firstBin, pixel.numBins);
+
+        auto value = 0.f;
+        for (int bin = pixel.firstBin; bin < pixel.firstBin + pixel.numBins; ++bin)
+            value += data[bin];
+
+        return value / (float) pixel.numBins;
     }
 
-    int getNumPathsAvailable() const
+private:
+    struct Pixel
+    {
+        int source = 0;
+        int firstBin = 0, numBins = 0;
+        float fraction = 0.f;   // with numBins == 0: position between firstBin and firstBin + 1
+    };
+
+    struct SourceLayout
     {
-        return pathFifo.getNumAvailableForReading();
+        int fftSize = 0;
+        double sampleRate = 0, maxFrequency = 0;
+
+        bool operator==(const SourceLayout& other) const
+        {
+            return fftSize == other.fftSize && sampleRate == other.sampleRate && maxFrequency == other.maxFrequency;
+        }
+    };
+
+    std::vector<Pixel> pixels;
+    int mapNumPixels = 0, mapNumSources = 0;
+    std::array<SourceLayout, maxSources> mapLayout;
+};
+
+/**
+ hands the latest of a series of values from one writer thread to one reader thread without locks
+ or copies: the writer fills its own buffer & swaps it into the middle, the reader swaps the middle
+ out when it holds something new. neither side ever waits, and the reader only ever sees whole buffers.
+ */
+template<typename T>
+struct TripleBuffer
+{
+    // writer: fill this one, then publish()
+    T& getWriteBuffer() { return buffers[(size_t) writeIndex]; }
+
+    void publish() { writeIndex = middle.exchange(writeIndex | freshBit) & indexMask; }
+
+    // reader: switches to the most recently published buffer, if there is one since the last call
+    bool update()
+    {
+        if ((middle.load() & freshBit) == 0)
+            return false;
+
+        readIndex = middle.exchange(readIndex) & indexMask;
+        return true;
     }
 
-    bool getPath(PathType& path)
+    const T& getReadBuffer() const { return buffers[(size_t) readIndex]; }
+
+    // before either side runs
+    std::array<T, 3>& getBuffersForSetup() { return buffers; }
+
+private:
+    static constexpr int indexMask = 3, freshBit = 4;
+
+    std::array<T, 3> buffers;
+    int writeIndex = 0, readIndex = 1;
+    std::atomic<int> middle { 2 };
+};
+
+// one analyzer trace in component coordinates: a point per pixel column, the first at 'x'
+struct AnalyzerTrace
+{
+    float x = 0;
+    std::vector<float> y;
+    int numPoints = 0;
+};
+
+struct AnalyzerTraceGenerator
+{
+    // allocates every buffer for 'maxNumPoints' columns, before the threads start
+    void prepare(int maxNumPoints)
     {
-        return pathFifo.pull(path);
+        for (auto& trace : traces.getBuffersForSetup())
+            trace.y.resize((size_t) maxNumPoints);
     }
+
+    /*
+     converts the sources' data into a point per pixel column of 'fftBounds', 'bottomValue' &
+     'topValue' landing on its bottom & top
+     */
+    void generateTrace(const SpectrumSource* sources,
+                       int numSources,
+                       juce::Rectangle<float> fftBounds,
+                       BinReduction reduction,
+                       float bottomValue,
+                       float topValue)
+    {
+        auto top = fftBounds.getY();
+        auto bottom = fftBounds.getBottom();
+        auto width = (int) fftBounds.getWidth();
+
+        if (width <= 0)
+            return;
+
+        pixelMap.update(width, sources, numSources);
+
+        auto& trace = traces.getWriteBuffer();
+
+        // only when the editor got wider than prepare() allowed for
+        if ((int) trace.y.size() < width)
+            trace.y.resize((size_t) width);
+
+        trace.x = fftBounds.getX();
+        trace.numPoints = width;
+
+        for (int x = 0; x < width; ++x)
+        {
+            const auto y = juce::jmap(pixelMap.getValue(x, sources, reduction), bottomValue, topValue, bottom, top);
+
+            jassert( !std::isnan(y) && !std::isinf(y) );
+
+            trace.y[(size_t) x] = y;
+        }
+
+        traces.publish();
+    }
+
+    // message thread: the most recent finished trace, valid until the next call
+    const AnalyzerTrace& getLatestTrace()
+    {
+        traces.update();
+        return traces.getReadBuffer();
+    }
+private:
+    TripleBuffer<AnalyzerTrace> traces;
+    FrequencyPixelMap pixelMap;
+};
+
+/**
+ the spectrogram's side of the analyzer thread: one row of colours per analysis frame, on the same
+ frequency axis as the paths, coloured through a lookup table built once.
+
+ the rows are written straight into a ring of slots allocated up front at the widest a row can be, and
+ the message thread reads them where they are, so nothing is copied or allocated on the way.
+ */
+struct SpectrogramRowGenerator
+{
+    static constexpr int maxRowWidth = 4096;
+
+    SpectrogramRowGenerator() : pixels((size_t) (numSlots * maxRowWidth)) {}
+
+    // false when the row was dropped because the message thread hasn't taken enough of the earlier ones
+    bool generateRow(const SpectrumSource* sources,
+                     int numSources,
+                     int width,
+                     BinReduction reduction,
+                     float negativeInfinity)
+    {
+        width = juce::jmin(width, maxRowWidth);
+        if (width <= 0)
+            return true;
+
+        const auto write = rowFifo.write(1);
+        if (write.blockSize1 == 0)
+            return false;
+
+        pixelMap.update(width, sources, numSources);
+
+        const auto& colours = getColourTable();
+        const auto scale = float(colours.size() - 1) / -negativeInfinity;
+
+        auto* row = getSlot(write.startIndex1);
+        for (int x = 0; x < width; ++x)
+        {
+            const auto index = (int) ((pixelMap.getValue(x, sources, reduction) - negativeInfinity) * scale);
+            row[x] = colours[(size_t) juce::jlimit(0, (int) colours.size() - 1, index)];
+        }
+
+        rowWidths[(size_t) write.startIndex1] = width;
+        return true;
+    }
+
+    // message thread: calls addRow(const juce::PixelARGB* row, int width) for every finished row,
+    // oldest first. the slots are only handed back to the analyzer thread once they've all been seen
+    template<typename Callback>
+    void readRows(Callback&& addRow)
+    {
+        const auto read = rowFifo.read(rowFifo.getNumReady());
+
+        read.forEach([this, &addRow](int slot)
+        {
+            addRow(static_cast<const juce::PixelARGB*>(getSlot(slot)), rowWidths[(size_t) slot]);
+        });
+    }
+
+    // from the floor to 0 dB
+    static const std::array<juce::PixelARGB, 256>& getColourTable()
+    {
+        static const auto table = []
+        {
+            juce::ColourGradient gradient(juce::Colours::black, 0.f, 0.f, juce::Colours::white, 1.f, 0.f, false);
+            gradient.addColour(0.25, juce::Colours::darkblue);
+            gradient.addColour(0.5, juce::Colours::purple);
+            gradient.addColour(0.7, juce::Colours::orangered);
+            gradient.addColour(0.9, juce::Colours::yellow);
+
+            std::array<juce::PixelARGB, 256> colours;
+            gradient.createLookupTable(colours.data(), (int) colours.size());
+            return colours;
+        }();
+
+        return table;
+    }
+
+private:
+    static constexpr int numSlots = 30;
+
+    juce::PixelARGB* getSlot(int slot) { return pixels.data() + (size_t) slot * maxRowWidth; }
+
+    juce::AbstractFifo rowFifo { numSlots };
+    std::vector<juce::PixelARGB> pixels;
+    std::array<int, numSlots> rowWidths {};
+    FrequencyPixelMap pixelMap;
+};
+
+/**
+ the spectrogram's side of the message thread: a ring of rows in one image. a new row overwrites the
+ oldest, and drawing starts from the newest one, so nothing already in the image is touched again.
+ */
+struct SpectrogramImage
+{
+    // writes the new row at the top, everything older moves down one
+    void addRow(const juce::PixelARGB* row, int width, int height);
+
+    void draw(juce::Graphics& g, juce::Rectangle<int> area) const;
+
 private:
-    Fifo<PathType> pathFifo;
+    juce::Image image;
+    int newestRow = 0;
 };
 
 struct LookAndFeel : juce::LookAndFeel_V4
@@ -198,28 +686,184 @@ private:
     juce::String suffix;
 };
 
-struct PathProducer
+/**
+ turns the stereo signal into analyzer paths, one complex FFT per frame for both channels. the FFTs,
+ dB conversion & path building all run on a background thread shared by every editor in the process,
+ the message thread only picks up the result.
+
+ with multi-resolution on, the signal is also low passed & decimated to 5 - 10 kHz and analysed with
+ an FFT of the same size. below the crossover the paths come from that low band: at 48 kHz & 2048
+ points its bins are 2.9 Hz apart instead of 23 Hz, for one more FFT of the same size & the decimation.
+ */
+struct PathProducer : private juce::TimeSliceClient
 {
-    PathProducer(SingleChannelSampleFifo<SimpleEQAudioProcessor::BlockType>& scsf) :
-    leftChannelFifo(&scsf)
+    PathProducer(SingleChannelSampleFifo<float>& leftFifo, SingleChannelSampleFifo<float>& rightFifo,
+                 PipelineProfiler& profilerToUse) :
+    profiler(profilerToUse),
+    channelFifos { &leftFifo, &rightFifo }
     {
         // 48000 / 2048 = 23hz
-        leftChannelFFTDataGenerator.changeOrder(FFTOrder::order2048);
-        monoBuffer.setSize(1, leftChannelFFTDataGenerator.getFFTSize());
+        fullBand.prepare(FFTOrder::order2048);
+        lowBand.prepare(FFTOrder::order2048);
+
+        decimationScratch.resize((size_t) 1 << FFTOrder::maxFFTOrder);
+
+        // wide enough for any editor size short of a 4k screen, traces never allocate after this
+        for (auto& producers : traceProducers)
+            for (auto& producer : producers)
+                producer.prepare(maxTraceWidth);
+
+        correlationTraceProducer.prepare(maxTraceWidth);
+
+        analyzerThread->addTimeSliceClient(this);
     }
-    void process(juce::Rectangle<float> fftBounds, double sampleRate);
-    juce::Path getPath() { return leftChannelFFTPath; }
+
+    ~PathProducer() override
+    {
+        // waits for a running slice to finish
+        analyzerThread->removeTimeSliceClient(this);
+    }
+
+    struct Settings
+    {
+        juce::Rectangle<float> fftBounds;   // where the paths are drawn
+        double sampleRate = 0;
+        float overlap = 0.5f;               // of consecutive analysis windows
+        FFTOrder order = FFTOrder::order2048;
+        BinReduction reduction = BinReduction::max;
+        float averagingTime = 0.f;          // seconds, 0 shows every frame as it is
+        float peakDecayPerSecond = 20.f;    // dB per second the peak hold trace falls back by
+        bool peakHold = false, maxHold = false;
+        bool midSide = false;               // paths for mid & side rather than left & right
+        bool correlation = false;           // a path for the inter-channel correlation as well
+        bool multiResolution = false;       // the low frequencies from a decimated, finer analysis
+        bool spectrogram = false;           // spectrogram rows instead of paths
+        bool active = false;                // whether paths are wanted at all
+    };
+
+    // message thread
+    void setSettings(const Settings& newSettings);
+
+    enum class Trace
+    {
+        spectrum,
+        peakHold,
+        maxHold,
+        numTraces
+    };
+
+    // message thread: the most recent finished trace of Spectrum::left, right, mid or side, valid until
+    // the next call for the same one
+    const AnalyzerTrace& getTrace(Spectrum spectrum, Trace trace = Trace::spectrum);
+
+    // message thread: the most recent correlation, +1 at the top of fftBounds & -1 at the bottom
+    const AnalyzerTrace& getCorrelationTrace();
+
+    // message thread: adds every finished spectrogram row to 'image', oldest first
+    void updateSpectrogram(SpectrogramImage& image, int height);
+
+    // message thread: whether paths or spectrogram rows were finished since the last call
+    bool pullNewData();
 private:
-    SingleChannelSampleFifo<SimpleEQAudioProcessor::BlockType>* leftChannelFifo;
+    struct AnalyzerThread : juce::TimeSliceThread
+    {
+        AnalyzerThread() : juce::TimeSliceThread("SimpleEQ Analyzer") { startThread(); }
+        ~AnalyzerThread() override { stopThread(2000); }
+    };
+
+    juce::SharedResourcePointer<AnalyzerThread> analyzerThread;
+
+    // the fft & traces stages, and what the fifos drop on the way
+    PipelineProfiler& profiler;
+
+    juce::SpinLock settingsLock;
+    Settings settings;
+
+    std::atomic<bool> newData { false };
+
+    static constexpr float negativeInfinity = -48.f;
+    static constexpr int maxTraceWidth = 4096;
+
+    // the low band's rate ends up between this and twice this, whatever the host rate
+    static constexpr double minimumLowBandRate = 5000.0;
+    static constexpr float lowBandCutoff = 1600.f;
+    static constexpr double crossoverFrequency = 800.0;
+
+    // one analysis resolution: its history of both channels, FFT, ballistics & correlation
+    struct Band
+    {
+        // allocates
+        void prepare(FFTOrder order);
+        // keeps the history, restarts the traces
+        void changeOrder(FFTOrder order);
+        // forgets the history & the traces
+        void reset();
+        void resetTraces();
+
+        // slides the history along by 'numSamples' & returns where the new ones go
+        float* makeRoom(int channel, int numSamples);
+        // after makeRoom() & writing both channels. 'numArrived' includes samples dropped or skipped on the way
+        void samplesAdded(int numWritten, int numArrived);
+
+        // one FFT & ballistics update once a hop has come in. true when the traces changed
+        bool analyse(const Settings& currentSettings, double sampleRate, PipelineProfiler& profiler);
+
+        juce::AudioBuffer<float> history;
+        FFTDataGenerator<std::vector<float>> fftDataGenerator;
+
+        // samples that arrived since the last analysis, and how much of the history holds real audio
+        int samplesSinceLastFrame = 0, numValidSamples = 0;
+
+        // of those, the ones dropped or skipped on the way rather than written to the history
+        int samplesLostSinceLastFrame = 0;
+
+        // audio time between the last two frames, for the ballistics
+        int samplesSinceLastAnalysis = 0;
+
+        // one per dB spectrum, all of them kept running so switching to mid/side picks up where it is
+        std::array<SpectrumBallistics, numDecibelSpectra> ballistics;
+        CorrelationSpectrum correlation;
+
+        // whether the traces hold an analysis yet
+        bool hasFrame = false;
+    };
+
+    Band fullBand, lowBand;
+
+    // anti-aliasing for the low band, per channel
+    std::array<FilterCascade<float>, 2> decimationFilters;
+    CascadeCoefficients<float> decimationCoefficients;
+    std::vector<float> decimationScratch;
+    int decimationFactor = 1, decimationPhase = 0;
+    double decimationSampleRate = 0;
+
+    bool maxHoldWasOn = false, multiResolutionWasOn = false;
+
+    // whether the previous slice analysed. when analysis starts (again), resync() throws away stale samples first
+    bool capturing = false;
 
-    juce::AudioBuffer<float> monoBuffer;
+    int useTimeSlice() override;
+    void process(const Settings& currentSettings);
+    void resync();
 
-    FFTDataGenerator<std::vector<float>> leftChannelFFTDataGenerator;
+    // designs the anti-aliasing filter & picks the decimation factor for a host rate
+    void prepareDecimation(double sampleRate);
+    void resetLowBand();
 
-    AnalyzerPathGenerator<juce::Path> pathProducer;
+    // feeds the newest 'numSamples' of the full band's history into the low band
+    void decimate(int numSamples);
 
-    juce::Path leftChannelFFTPath;
+    void generatePaths(const Settings& currentSettings);
 
+    std::array<SingleChannelSampleFifo<float>*, 2> channelFifos;
+    using Ring = SingleChannelSampleFifo<float>::ReadScope;
+
+    static constexpr auto numTraces = static_cast<size_t>(Trace::numTraces);
+
+    std::array<std::array<AnalyzerTraceGenerator, numTraces>, numDecibelSpectra> traceProducers;
+    AnalyzerTraceGenerator correlationTraceProducer;
+
+    SpectrogramRowGenerator spectrogramRowProducer;
 };
 
 struct ResponseCurveComponent : juce::Component, juce::AudioProcessorParameter::Listener,
@@ -241,14 +885,50 @@ juce::Timer
     void toggleAnalysisEnablement(bool enabled)
     {
         shouldShowFFTAnalysis = enabled;
+        repaint(getRenderArea().expanded(2));
     }
 
+    // the analyzer's & the curve's timings, off until something enables it
+    PipelineProfiler& getProfiler() { return profiler; }
+    const PipelineProfiler& getProfiler() const { return profiler; }
+
 private:
     SimpleEQAudioProcessor& processorRef;
     juce::Atomic<bool> parametersChanged {false};
-    MonoChain monoChain;
 
-    void updateChain();
+    // the analyzer's parameters, looked up once rather than by name on every tick
+    struct AnalyserParameters
+    {
+        explicit AnalyserParameters(juce::AudioProcessorValueTreeState& apvts);
+
+        std::atomic<float>* enabled;
+        std::atomic<float>* overlap;
+        std::atomic<float>* resolution;
+        std::atomic<float>* averaging;
+        std::atomic<float>* peakHold;
+        std::atomic<float>* peakDecay;
+        std::atomic<float>* maxHold;
+        std::atomic<float>* mode;
+        std::atomic<float>* correlation;
+        std::atomic<float>* multiResolution;
+        std::atomic<float>* display;
+        std::atomic<float>* binReduction;
+    };
+
+    const AnalyserParameters analyserParams;
+
+    // the response curve, kept per band in dB so a change to one band only re-evaluates that band.
+    // rebuilt when a parameter, the analysis area or the sample rate changes, not per repaint
+    std::array<std::vector<float>, 3> bandMagnitudes;
+    std::vector<float> magnitudes;
+    juce::Path responseCurve;
+    FrequencyResponse curveResponse;
+
+    ChainSettings curveSettings;
+    juce::Rectangle<int> curveArea;
+    double curveSampleRate = 0;
+
+    void updateResponseCurve();
 
     juce::Image background;
 
@@ -256,9 +936,36 @@ private:
 
     juce::Rectangle<int> getAnalysisArea();
 
-    PathProducer leftPathProducer, rightPathProducer;
+    PipelineProfiler profiler;
+    PathProducer pathProducer;
+    SpectrogramImage spectrogramImage;
+
+    bool shouldShowFFTAnalysis = false;
+    bool showPeakHold = false, showMaxHold = false, showMidSide = false, showCorrelation = false, showSpectrogram = false;
+
+    // rebuilt from the trace points for every stroke, its storage is kept between paints
+    juce::Path tracePath;
+    void strokeTrace(juce::Graphics& g, const AnalyzerTrace& trace, juce::Colour colour);
+};
+
+/**
+ debug overlay over the response curve: min / mean / p99 per stage of a PipelineProfiler, and what
+ the fifos dropped. it enables the profiler while it's visible and refreshes a few times a second.
+ */
+struct ProfilerOverlay : juce::Component, juce::Timer
+{
+    explicit ProfilerOverlay(PipelineProfiler& profilerToShow);
+    ~ProfilerOverlay() override;
+
+    void paint(juce::Graphics& g) override;
+    void visibilityChanged() override;
+    void timerCallback() override { repaint(); }
+
+    // enough for every line in the default font
+    static constexpr int preferredWidth = 310, preferredHeight = 100;
 
-    bool shouldShowFFTAnalysis;
+private:
+    PipelineProfiler& profiler;
 };
 
 struct PowerButton : juce::ToggleButton {};
@@ -286,6 +993,17 @@ struct AnalyserButton : juce::ToggleButton
     juce::Path randomPath;
 };
 
+// filled with a choice parameter's choices, as "<prefix> <choice>", before a ComboBoxAttachment picks one
+struct ChoiceComboBox : juce::ComboBox
+{
+    ChoiceComboBox(const juce::RangedAudioParameter& param, const juce::String& prefix = {})
+    {
+        const auto choices = param.getAllValueStrings();
+        for (int i = 0; i < choices.size(); ++i)
+            addItem(prefix.isEmpty() ? choices[i] : prefix + " " + choices[i], i + 1);
+    }
+};
+
 
 //==============================================================================
 class SimpleEQAudioProcessorEditor : public juce::AudioProcessorEditor
@@ -297,6 +1015,18 @@ public:
     //==============================================================================
     void paint (juce::Graphics&) override;
     void resized() override;
+
+    // ctrl / cmd + shift + P shows & hides the profiler overlay, like profilerButton. only when the
+    // editor has keyboard focus, which most hosts keep for themselves
+    bool keyPressed(const juce::KeyPress& key) override;
+
+    void setProfilerOverlayVisible(bool shouldBeVisible);
+    bool isProfilerOverlayVisible() const { return profilerOverlay.isVisible(); }
+
+    // the same numbers as the overlay. only recorded while the overlay is up
+    // or the profiler has been enabled some other way
+    PipelineProfiler::Stats getProfilerStats() const;
+    PipelineProfiler& getProfiler() { return responseCurveComponent.getProfiler(); }
 private:
     // This reference is provided as a quick way for your editor to
     // access the processor object that created it.
@@ -305,6 +1035,7 @@ private:
     RotarySliderWithLabels peakFreqSlider, peakGainSlider, peakQualitySlider, lowCutFreqSlider, highCutFreqSlider, lowCutSlopeSlider, highCutSlopeSlider;
 
     ResponseCurveComponent responseCurveComponent;
+    ProfilerOverlay profilerOverlay;
 
     using APVTS = juce::AudioProcessorValueTreeState;
     using Attachment = APVTS::SliderAttachment;
@@ -320,12 +1051,52 @@ private:
     AnalyserButton
         analyserEnabledButton;
 
+    // shows & hides the profiler overlay
+    juce::ToggleButton profilerButton { "Timings" };
+
+    // processing modes
+    ChoiceComboBox oversamplingBox, linearPhasePartitionBox;
+    juce::ToggleButton linearPhaseButton { "Linear Phase" };
+
+    // analyser settings, two rows under the top one
+    ChoiceComboBox analyserResolutionBox, analyserOverlapBox, analyserAveragingBox, analyserBinReductionBox,
+                   analyserPeakDecayBox, analyserModeBox, analyserDisplayBox;
+    juce::ToggleButton
+        analyserPeakHoldButton { "Peak Hold" },
+        analyserMaxHoldButton { "Max Hold" },
+        analyserCorrelationButton { "Correlation" },
+        analyserMultiResolutionButton { "Multi-Res" };
+
     using ButtonAttachment = APVTS::ButtonAttachment;
     ButtonAttachment
         lowcutBypassButtonAttachment,
         highcutBypassButtonAttachment,
         peakBypassButtonAttachment,
-        analyserEnabledButtonAttachment;
+        analyserEnabledButtonAttachment,
+        linearPhaseButtonAttachment,
+        analyserPeakHoldButtonAttachment,
+        analyserMaxHoldButtonAttachment,
+        analyserCorrelationButtonAttachment,
+        analyserMultiResolutionButtonAttachment;
+
+    using ComboBoxAttachment = APVTS::ComboBoxAttachment;
+    ComboBoxAttachment
+        oversamplingBoxAttachment,
+        linearPhasePartitionBoxAttachment,
+        analyserResolutionBoxAttachment,
+        analyserOverlapBoxAttachment,
+        analyserAveragingBoxAttachment,
+        analyserBinReductionBoxAttachment,
+        analyserPeakDecayBoxAttachment,
+        analyserModeBoxAttachment,
+        analyserDisplayBoxAttachment;
+
+    // oversampling only applies to the IIR filters, the partition size only to the FIR
+    void updateProcessingModeControls();
+
+    // the analyser settings do nothing while it's off
+    void updateAnalyserControls();
+    std::vector<juce::Component*> getAnalyserComps();
 
     // iterate through this vector
     std::vector<juce::Component*> getComps();
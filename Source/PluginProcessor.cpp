@@ -12,10 +12,27 @@ SimpleEQAudioProcessor::SimpleEQAudioProcessor()
                      #endif
                        )
 {
+    oversamplingParam = apvts.getRawParameterValue("Oversampling");
+    linearPhaseParam = apvts.getRawParameterValue("Linear Phase");
+    analyserEnabledParam = apvts.getRawParameterValue("Analyser Enabled");
+
+    // nothing's in the cascade until the first rebuild
+    cascadePositions.fill(-1);
+
+    for (auto* param : getParameters())
+    {
+        if (auto* rap = dynamic_cast<juce::RangedAudioParameter*>(param))
+            apvts.addParameterListener(rap->paramID, this);
+    }
 }
 
 SimpleEQAudioProcessor::~SimpleEQAudioProcessor()
 {
+    for (auto* param : getParameters())
+    {
+        if (auto* rap = dynamic_cast<juce::RangedAudioParameter*>(param))
+            apvts.removeParameterListener(rap->paramID, this);
+    }
 }
 
 //==============================================================================
@@ -89,17 +106,40 @@ void SimpleEQAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlo
     // Use this method as the place to do any pre-playback
     // initialisation that you need.
 
-    // pass processSpec obj to the chain that will pass to each link in the chain
-    juce::dsp::ProcessSpec spec;
-    spec.maximumBlockSize = samplesPerBlock;
-    spec.numChannels = 1;
-    spec.sampleRate = sampleRate;
+    maxBlockSize = (size_t) samplesPerBlock;
 
-    leftChain.prepare(spec);
-    rightChain.prepare(spec);
+    // oversampling stages for 2x & 4x, plus design tables for every rate we can run at,
+    // so switching the factor later on doesn't allocate
+    numPreparedChannels = (size_t) juce::jlimit(1, maxChannels, getTotalNumOutputChannels());
 
-    // update lowcut filter, peak filter & highcut filter
-    updateFilters();
+    // the host picks the precision before preparing us, so only that path needs its buffers
+    if (isUsingDoublePrecision())
+    {
+        floatState.release();
+        doubleState.prepare(numPreparedChannels, maxBlockSize);
+        linearPhaseScratch.setSize((int) numPreparedChannels, samplesPerBlock);
+    }
+    else
+    {
+        doubleState.release();
+        floatState.prepare(numPreparedChannels, maxBlockSize);
+        linearPhaseScratch.setSize(0, 0);
+    }
+
+    for (size_t order = 0; order < oversampledTables.size(); ++order)
+        oversampledTables[order] = CoefficientTables::getFor(sampleRate * (1 << order));
+
+    // jump straight to the current parameter values, design every band for the processing rate
+    // and start from silence
+    setOversamplingOrder((int) oversamplingParam->load());
+
+    linearPhaseEQ.prepare(sampleRate, (int) numPreparedChannels, samplesPerBlock);
+    linearPhaseActive = linearPhaseParam->load() > 0.5f;
+
+    // audio isn't running, so this one can go to the host straight away
+    cancelPendingUpdate();
+    pendingLatency = getCurrentLatency();
+    setLatencySamples(pendingLatency);
 
     // prepare fifos
     leftChannelFifo.prepare(samplesPerBlock);
@@ -118,6 +158,37 @@ void SimpleEQAudioProcessor::releaseResources()
     // spare memory, etc.
 }
 
+template<typename FloatType>
+void SimpleEQAudioProcessor::ProcessingState<FloatType>::prepare(size_t numChannels, size_t maxBlockSize)
+{
+    // oversampling stages for 2x & 4x, so switching the factor later on doesn't allocate
+    for (size_t i = 0; i < oversamplers.size(); ++i)
+    {
+        oversamplers[i] = std::make_unique<juce::dsp::Oversampling<FloatType>>(
+            numChannels,
+            i + 1,
+            juce::dsp::Oversampling<FloatType>::filterHalfBandPolyphaseIIR,
+            true,    // max quality
+            true);   // integer latency, so it can be reported to the host exactly
+        oversamplers[i]->initProcessing(maxBlockSize);
+    }
+
+    // one interleave buffer, reused by every batch of channels
+    const auto maxOversampledBlockSize = maxBlockSize << maxOversamplingOrder;
+    interleaved = juce::dsp::AudioBlock<BatchSample>(interleavedData, 1, maxOversampledBlockSize);
+    interleaved.clear();
+}
+
+template<typename FloatType>
+void SimpleEQAudioProcessor::ProcessingState<FloatType>::release()
+{
+    for (auto& oversampler : oversamplers)
+        oversampler.reset();
+
+    interleaved = {};
+    interleavedData.free();
+}
+
 bool SimpleEQAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
 {
   #if JucePlugin_IsMidiEffect
@@ -125,11 +196,10 @@ bool SimpleEQAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts)
     return true;
   #else
     // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // Any layout up to maxChannels works: mono, stereo, surround & immersive beds
+    // and ambisonics up to 3rd order (16 channels). All channels share one set of filters.
+    const auto& mainOutput = layouts.getMainOutputChannelSet();
+    if (mainOutput.isDisabled() || mainOutput.size() > maxChannels)
         return false;
 
     // This checks if the input layout matches the output layout
@@ -146,7 +216,19 @@ void SimpleEQAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer,
                                               juce::MidiBuffer& midiMessages)
 {
     juce::ignoreUnused (midiMessages);
+    process(buffer);
+}
 
+void SimpleEQAudioProcessor::processBlock (juce::AudioBuffer<double>& buffer,
+                                              juce::MidiBuffer& midiMessages)
+{
+    juce::ignoreUnused (midiMessages);
+    process(buffer);
+}
+
+template<typename FloatType>
+void SimpleEQAudioProcessor::process(juce::AudioBuffer<FloatType>& buffer)
+{
     juce::ScopedNoDenormals noDenormals;
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
@@ -160,32 +242,236 @@ void SimpleEQAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer,
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
 
-    // update lowcut filter, peak filter & highcut filter
+    const auto newOversamplingOrder = (int) oversamplingParam->load();
+    if (newOversamplingOrder != oversamplingOrder)
+        setOversamplingOrder(newOversamplingOrder);
+
+    // switching modes starts the newly used path from silence
+    const auto linearPhase = linearPhaseParam->load() > 0.5f;
+    if (linearPhase != linearPhaseActive)
+    {
+        linearPhaseActive = linearPhase;
+        linearPhaseActive ? linearPhaseEQ.reset() : resetCascades();
+    }
+
+    // redesign only the bands whose parameters changed since the last block
     updateFilters();
 
     // create audio block that wraps the buffer
-    juce::dsp::AudioBlock<float> block(buffer);
+    juce::dsp::AudioBlock<FloatType> block(buffer);
 
     // // use oscillator
     // buffer.clear();
     // juce::dsp::ProcessContextReplacing<float> stereoContext(block);
     // osc.process(stereoContext);
 
-    // extra individual channels from the buffer
-    auto leftBlock = block.getSingleChannelBlock(0);
-    auto rightBlock = block.getSingleChannelBlock(1);
+    // the oversamplers were prepared for maxBlockSize, so feed them no more than that at a time
+    const auto numChannels = juce::jmin(block.getNumChannels(), numPreparedChannels);
+    for (size_t start = 0; start < block.getNumSamples(); start += maxBlockSize)
+    {
+        auto chunk = block.getSubsetChannelBlock(0, numChannels)
+                          .getSubBlock(start, juce::jmin(maxBlockSize, block.getNumSamples() - start));
+
+        if (linearPhaseActive)
+        {
+            processLinearPhase(chunk);
+        }
+        else if (oversamplingOrder > 0)
+        {
+            auto& oversampler = *getState<FloatType>().oversamplers[(size_t) oversamplingOrder - 1];
+            auto oversampledBlock = oversampler.processSamplesUp(juce::dsp::AudioBlock<const FloatType>(chunk));
+            processFilters(oversampledBlock);
+            oversampler.processSamplesDown(chunk);
+        }
+        else
+        {
+            processFilters(chunk);
+        }
+    }
+
+    updateLatency();
+
+    if (numAnalyserConsumers.load(std::memory_order_relaxed) > 0 && analyserEnabledParam->load() > 0.5f)
+    {
+        leftChannelFifo.update(buffer);
+        rightChannelFifo.update(buffer);
+    }
+}
+
+void SimpleEQAudioProcessor::setOversamplingOrder(int newOrder)
+{
+    oversamplingOrder = juce::jlimit(0, maxOversamplingOrder, newOrder);
+
+    // everything downstream runs at the oversampled rate
+    coefficientTables = oversampledTables[(size_t) oversamplingOrder];
+    resetSmoothing(getSampleRate() * (1 << oversamplingOrder));
+    // the FIR runs at the host rate whatever the factor, only the IIR bands need redesigning
+    markIIRFiltersDirty();
+    updateFilters();
+    resetCascades();
+
+    // only the prepared precision has oversamplers, its latency is the one we report
+    oversamplingLatency = 0;
+
+    auto resetOversamplers = [this] (auto& state)
+    {
+        for (auto& oversampler : state.oversamplers)
+            if (oversampler != nullptr)
+                oversampler->reset();
+
+        if (oversamplingOrder > 0 && state.oversamplers[(size_t) oversamplingOrder - 1] != nullptr)
+            oversamplingLatency = juce::roundToInt(state.oversamplers[(size_t) oversamplingOrder - 1]->getLatencyInSamples());
+    };
+
+    resetOversamplers(floatState);
+    resetOversamplers(doubleState);
+}
+
+int SimpleEQAudioProcessor::getCurrentLatency() const
+{
+    // linear phase mode bypasses the oversampling, so only one of them ever adds latency
+    return linearPhaseActive ? linearPhaseEQ.getLatencySamples() : oversamplingLatency;
+}
+
+void SimpleEQAudioProcessor::updateLatency()
+{
+    const auto latency = getCurrentLatency();
+
+    if (latency != pendingLatency.load(std::memory_order_relaxed))
+    {
+        pendingLatency = latency;
+        triggerAsyncUpdate();
+    }
+}
+
+void SimpleEQAudioProcessor::handleAsyncUpdate()
+{
+    setLatencySamples(pendingLatency);
+}
 
-    // create processing context that wraps each individual audio block for the channels
-    juce::dsp::ProcessContextReplacing<float> leftContext(leftBlock);
-    juce::dsp::ProcessContextReplacing<float> rightContext(rightBlock);
+double SimpleEQAudioProcessor::getFilterSampleRate() const
+{
+    if (linearPhaseParam->load() > 0.5f)
+        return getSampleRate();
 
-    // pass contexts to monofilter chains
-    leftChain.process(leftContext);
-    rightChain.process(rightContext);
+    return getSampleRate() * (1 << juce::jlimit(0, maxOversamplingOrder, (int) oversamplingParam->load()));
+}
 
-    leftChannelFifo.update(buffer);
-    rightChannelFifo.update(buffer);
+template<typename FloatType>
+void SimpleEQAudioProcessor::processLinearPhase(juce::dsp::AudioBlock<FloatType>& block)
+{
+    if constexpr (std::is_same_v<FloatType, float>)
+    {
+        linearPhaseEQ.process(block);
+    }
+    else
+    {
+        const auto numChannels = juce::jmin(block.getNumChannels(), (size_t) linearPhaseScratch.getNumChannels());
+        const auto numSamples = block.getNumSamples();
+        auto scratch = juce::dsp::AudioBlock<float>(linearPhaseScratch).getSubsetChannelBlock(0, numChannels)
+                                                                        .getSubBlock(0, numSamples);
+
+        for (size_t ch = 0; ch < numChannels; ++ch)
+        {
+            const auto* source = block.getChannelPointer(ch);
+            auto* dest = scratch.getChannelPointer(ch);
+            for (size_t i = 0; i < numSamples; ++i)
+                dest[i] = static_cast<float>(source[i]);
+        }
+
+        linearPhaseEQ.process(scratch);
+
+        for (size_t ch = 0; ch < numChannels; ++ch)
+        {
+            const auto* source = scratch.getChannelPointer(ch);
+            auto* dest = block.getChannelPointer(ch);
+            for (size_t i = 0; i < numSamples; ++i)
+                dest[i] = static_cast<double>(source[i]);
+        }
+    }
+}
 
+template<typename FloatType>
+void SimpleEQAudioProcessor::processFilters(juce::dsp::AudioBlock<FloatType>& block)
+{
+    // run the channels through the cascade one SIMD-wide batch at a time, in chunks the
+    // interleave buffer can hold. while parameters glide, chunks end on the coefficient update grid
+    const auto numChannels = juce::jmin(block.getNumChannels(), (size_t) maxChannels);
+    const auto numSamples = block.getNumSamples();
+    const auto maxChunk = getState<FloatType>().interleaved.getNumSamples();
+
+    for (size_t start = 0; start < numSamples;)
+    {
+        auto chunkSize = juce::jmin(maxChunk, numSamples - start);
+
+        if (isSmoothing())
+        {
+            if (samplesUntilCoefficientUpdate == 0)
+            {
+                advanceSmoothing((int) coefficientUpdateInterval);
+                samplesUntilCoefficientUpdate = coefficientUpdateInterval;
+            }
+
+            chunkSize = juce::jmin(chunkSize, samplesUntilCoefficientUpdate);
+            samplesUntilCoefficientUpdate -= chunkSize;
+        }
+        else
+        {
+            // the next ramp starts redesigning on its very first sample
+            samplesUntilCoefficientUpdate = 0;
+        }
+
+        auto chunk = block.getSubBlock(start, chunkSize);
+
+        for (size_t firstChannel = 0; firstChannel < numChannels; firstChannel += ProcessingState<FloatType>::BatchSample::size())
+            processChannelBatch(chunk, firstChannel);
+
+        start += chunkSize;
+    }
+}
+
+template<typename FloatType>
+void SimpleEQAudioProcessor::processChannelBatch(juce::dsp::AudioBlock<FloatType>& block, size_t firstChannel)
+{
+    auto& state = getState<FloatType>();
+    const auto numSamples = block.getNumSamples();
+    const auto numLanes = ProcessingState<FloatType>::BatchSample::size();
+    const auto numChannels = juce::jmin(numLanes, block.getNumChannels() - firstChannel);
+    auto* lanes = reinterpret_cast<FloatType*>(state.interleaved.getChannelPointer(0));
+
+    for (size_t lane = 0; lane < numLanes; ++lane)
+    {
+        if (lane < numChannels)
+        {
+            auto* channel = block.getChannelPointer(firstChannel + lane);
+            for (size_t i = 0; i < numSamples; ++i)
+                lanes[i * numLanes + lane] = channel[i];
+        }
+        else
+        {
+            // the buffer is shared between batches, so a partial batch must silence its spare lanes
+            for (size_t i = 0; i < numSamples; ++i)
+                lanes[i * numLanes + lane] = FloatType(0);
+        }
+    }
+
+    state.batchCascades[firstChannel / numLanes].process(state.cascadeCoefficients, state.interleaved.getChannelPointer(0), numSamples);
+
+    for (size_t lane = 0; lane < numChannels; ++lane)
+    {
+        auto* channel = block.getChannelPointer(firstChannel + lane);
+        for (size_t i = 0; i < numSamples; ++i)
+            channel[i] = lanes[i * numLanes + lane];
+    }
+}
+
+void SimpleEQAudioProcessor::resetCascades()
+{
+    for (auto& cascade : floatState.batchCascades)
+        cascade.reset();
+
+    for (auto& cascade : doubleState.batchCascades)
+        cascade.reset();
 }
 
 //==============================================================================
@@ -218,7 +504,8 @@ void SimpleEQAudioProcessor::setStateInformation (const void* data, int sizeInBy
     if (tree.isValid())
     {
         apvts.replaceState(tree);
-        updateFilters();
+        // the audio thread picks the new state up on its next block
+        markAllFiltersDirty();
     }
 }
 
@@ -241,67 +528,307 @@ ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts)
     return settings;
 }
 
-Coefficients makePeakFilter(const ChainSettings& chainSettings, double sampleRate)
+static BiquadCoefficients makeBiquad(double b0, double b1, double b2, double a0, double a1, double a2)
 {
-    return juce::dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate, chainSettings.peakFreq, chainSettings.peakQuality, juce::Decibels::decibelsToGain(chainSettings.peakGainInDecibels)); // convert decibel to gain unit
+    const auto a0Inv = 1.0 / a0;
+    return { b0 * a0Inv, b1 * a0Inv, b2 * a0Inv, a1 * a0Inv, a2 * a0Inv };
+}
 
+// same formulas as juce::dsp::IIR::Coefficients::makeHighPass / makeLowPass / makePeakFilter,
+// minus the allocation, with the trig terms handed in so they can come from a table
+static BiquadCoefficients makeHighPass(const CoefficientTables::TrigTerms& trig, double Q)
+{
+    const auto n = trig.tanHalfOmega;
+    const auto nSquared = n * n;
+    const auto invQ = 1.0 / Q;
+    const auto c1 = 1.0 / (1.0 + invQ * n + nSquared);
+
+    return makeBiquad(c1, c1 * -2.0, c1, 1.0, c1 * 2.0 * (nSquared - 1.0), c1 * (1.0 - invQ * n + nSquared));
 }
 
+static BiquadCoefficients makeLowPass(const CoefficientTables::TrigTerms& trig, double Q)
+{
+    const auto n = 1.0 / trig.tanHalfOmega;
+    const auto nSquared = n * n;
+    const auto invQ = 1.0 / Q;
+    const auto c1 = 1.0 / (1.0 + invQ * n + nSquared);
 
-void SimpleEQAudioProcessor::updatePeakFilter(const ChainSettings& chainSettings)
+    return makeBiquad(c1, c1 * 2.0, c1, 1.0, c1 * 2.0 * (1.0 - nSquared), c1 * (1.0 - invQ * n + nSquared));
+}
+
+static BiquadCoefficients makePeak(const CoefficientTables::TrigTerms& trig, double A, double Q)
+{
+    const auto alpha = trig.sinOmega / (Q * 2.0);
+    const auto c2 = -2.0 * trig.cosOmega;
+    const auto alphaTimesA = alpha * A;
+    const auto alphaOverA = alpha / A;
+
+    return makeBiquad(1.0 + alphaTimesA, c2, 1.0 - alphaTimesA, 1.0 + alphaOverA, c2, 1.0 - alphaOverA);
+}
+
+template<typename SectionDesign>
+static CutCoefficients makeCut(const CoefficientTables::TrigTerms& trig, Slope slope, SectionDesign&& designSection)
 {
-    auto peakCoefficients = makePeakFilter(chainSettings, getSampleRate());
+    CutCoefficients coefficients;
+    const auto order = 2 * getNumCutSections(slope);
 
-    leftChain.setBypassed<ChainPositions::Peak>(chainSettings.peakBypassed);
-    rightChain.setBypassed<ChainPositions::Peak>(chainSettings.peakBypassed);
+    for (int i = 0; i < order / 2; ++i)
+        coefficients[(size_t) i] = designSection(trig, CoefficientTables::getButterworthQ(order, i));
 
-    // access peak filter link and add coefficients
-    updateCoefficients(leftChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
-    updateCoefficients(rightChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
+    return coefficients;
 }
 
-void updateCoefficients(Coefficients& old, const Coefficients& replacements)
+BiquadCoefficients makePeakFilter(const ChainSettings& chainSettings, double sampleRate)
 {
-    *old = *replacements;
+    return makePeak(CoefficientTables::computeTrigTerms(chainSettings.peakFreq, sampleRate),
+                    CoefficientTables::computePeakGainFactor(chainSettings.peakGainInDecibels),
+                    chainSettings.peakQuality);
 }
 
-void SimpleEQAudioProcessor::updateLowCutFilters(const ChainSettings& chainSettings)
+CutCoefficients makeLowCutFilter(const ChainSettings& chainSettings, double sampleRate)
+{
+    return makeCut(CoefficientTables::computeTrigTerms(chainSettings.lowCutFreq, sampleRate), chainSettings.lowCutSlope, makeHighPass);
+}
+
+CutCoefficients makeHighCutFilter(const ChainSettings& chainSettings, double sampleRate)
 {
-    auto cutCoefficients = makeLowCutFilter(chainSettings, getSampleRate());
+    return makeCut(CoefficientTables::computeTrigTerms(chainSettings.highCutFreq, sampleRate), chainSettings.highCutSlope, makeLowPass);
+}
 
-    auto& leftLowCut =  leftChain.get<ChainPositions::LowCut>();
-    auto& rightLowCut =  rightChain.get<ChainPositions::LowCut>();
+CascadeCoefficients<double> makeCascadeCoefficients(const ChainSettings& chainSettings, double sampleRate)
+{
+    CascadeCoefficients<double> cascade;
 
-    leftChain.setBypassed<ChainPositions::LowCut>(chainSettings.lowCutBypassed);
-    rightChain.setBypassed<ChainPositions::LowCut>(chainSettings.lowCutBypassed);
+    if (! chainSettings.lowCutBypassed)
+    {
+        const auto lowCut = makeLowCutFilter(chainSettings, sampleRate);
+        for (int i = 0; i < getNumCutSections(chainSettings.lowCutSlope); ++i)
+            cascade.add(lowCut[(size_t) i]);
+    }
 
-    updateCutFilter(leftLowCut, cutCoefficients, chainSettings.lowCutSlope);
-    updateCutFilter(rightLowCut, cutCoefficients,chainSettings.lowCutSlope);
+    if (! chainSettings.peakBypassed)
+        cascade.add(makePeakFilter(chainSettings, sampleRate));
 
+    if (! chainSettings.highCutBypassed)
+    {
+        const auto highCut = makeHighCutFilter(chainSettings, sampleRate);
+        for (int i = 0; i < getNumCutSections(chainSettings.highCutSlope); ++i)
+            cascade.add(highCut[(size_t) i]);
+    }
+
+    return cascade;
+}
+
+BiquadCoefficients makePeakFilter(const ChainSettings& chainSettings, const CoefficientTables& tables)
+{
+    return makePeak(tables.getTrigTerms(chainSettings.peakFreq),
+                    tables.getPeakGainFactor(chainSettings.peakGainInDecibels),
+                    chainSettings.peakQuality);
+}
+
+CutCoefficients makeLowCutFilter(const ChainSettings& chainSettings, const CoefficientTables& tables)
+{
+    return makeCut(tables.getTrigTerms(chainSettings.lowCutFreq), chainSettings.lowCutSlope, makeHighPass);
+}
+
+CutCoefficients makeHighCutFilter(const ChainSettings& chainSettings, const CoefficientTables& tables)
+{
+    return makeCut(tables.getTrigTerms(chainSettings.highCutFreq), chainSettings.highCutSlope, makeLowPass);
+}
+
+void SimpleEQAudioProcessor::updatePeakFilter(const ChainSettings& chainSettings)
+{
+    peakCoefficients = makePeakFilter(chainSettings, *coefficientTables);
+    peakActive = ! chainSettings.peakBypassed;
+}
+
+void SimpleEQAudioProcessor::updateLowCutFilters(const ChainSettings& chainSettings)
+{
+    lowCutCoefficients = makeLowCutFilter(chainSettings, *coefficientTables);
+    numLowCutSections = chainSettings.lowCutBypassed ? 0 : getNumCutSections(chainSettings.lowCutSlope);
 }
 
 void SimpleEQAudioProcessor::updateHighCutFilters(const ChainSettings& chainSettings)
 {
-    auto highCutCoefficients = makeHighCutFilter(chainSettings, getSampleRate());
-    auto& leftHighCut =  leftChain.get<ChainPositions::HighCut>();
-    auto& rightHighCut =  rightChain.get<ChainPositions::HighCut>();
+    highCutCoefficients = makeHighCutFilter(chainSettings, *coefficientTables);
+    numHighCutSections = chainSettings.highCutBypassed ? 0 : getNumCutSections(chainSettings.highCutSlope);
+}
+
+void SimpleEQAudioProcessor::rebuildCascade()
+{
+    // a handful of sections, cheaper to flatten into both precisions than to track which one is live
+    std::array<int, maxCascadeSections> positions;
+    positions.fill(-1);
+
+    auto flatten = [this, &positions] (auto& cascadeCoefficients)
+    {
+        cascadeCoefficients.clear();
+
+        for (int i = 0; i < numLowCutSections; ++i)
+        {
+            positions[(size_t) i] = cascadeCoefficients.numSections;
+            cascadeCoefficients.add(lowCutCoefficients[(size_t) i]);
+        }
+
+        if (peakActive)
+        {
+            positions[(size_t) maxCutSections] = cascadeCoefficients.numSections;
+            cascadeCoefficients.add(peakCoefficients);
+        }
 
-    leftChain.setBypassed<ChainPositions::HighCut>(chainSettings.highCutBypassed);
-    rightChain.setBypassed<ChainPositions::HighCut>(chainSettings.highCutBypassed);
+        for (int i = 0; i < numHighCutSections; ++i)
+        {
+            positions[(size_t) (maxCutSections + 1 + i)] = cascadeCoefficients.numSections;
+            cascadeCoefficients.add(highCutCoefficients[(size_t) i]);
+        }
+    };
 
-    updateCutFilter(leftHighCut, highCutCoefficients, chainSettings.highCutSlope);
-    updateCutFilter(rightHighCut, highCutCoefficients, chainSettings.highCutSlope);
+    flatten(floatState.cascadeCoefficients);
+    flatten(doubleState.cascadeCoefficients);
+
+    if (positions == cascadePositions)
+        return;
+
+    // sections shifted position: each one keeps its own state, only the ones just switched in start from zero
+    std::array<int, maxCascadeSections> previousPosition;
+    previousPosition.fill(-1);
+
+    for (size_t section = 0; section < positions.size(); ++section)
+        if (positions[section] >= 0)
+            previousPosition[(size_t) positions[section]] = cascadePositions[section];
+
+    for (auto& cascade : floatState.batchCascades)
+        cascade.moveState(previousPosition);
+
+    for (auto& cascade : doubleState.batchCascades)
+        cascade.moveState(previousPosition);
+
+    cascadePositions = positions;
 }
 
 void SimpleEQAudioProcessor::updateFilters()
 {
-    auto chainSettings = getChainSettings(apvts);
-    updateLowCutFilters(chainSettings);
-    updatePeakFilter(chainSettings);
-    updateHighCutFilters(chainSettings);
+    // clear the flags before reading the parameters so a change landing in between isn't lost
+    const bool lowCutChanged = lowCutDirty.compareAndSetBool(false, true);
+    const bool peakChanged = peakDirty.compareAndSetBool(false, true);
+    const bool highCutChanged = highCutDirty.compareAndSetBool(false, true);
+
+    if (! (lowCutChanged || peakChanged || highCutChanged))
+        return;
+
+    currentSettings = getChainSettings(apvts);
+
+    // unchanged targets don't restart a ramp
+    smoothedLowCutFreq.setTargetValue(currentSettings.lowCutFreq);
+    smoothedHighCutFreq.setTargetValue(currentSettings.highCutFreq);
+    smoothedPeakFreq.setTargetValue(currentSettings.peakFreq);
+    smoothedPeakGain.setTargetValue(currentSettings.peakGainInDecibels);
+    smoothedPeakQuality.setTargetValue(currentSettings.peakQuality);
+
+    // slopes & bypasses take effect straight away, the smoothed values follow on the update grid
+    auto chainSettings = getSmoothedSettings();
+
+    if (lowCutChanged)
+        updateLowCutFilters(chainSettings);
+    if (peakChanged)
+        updatePeakFilter(chainSettings);
+    if (highCutChanged)
+        updateHighCutFilters(chainSettings);
+
+    rebuildCascade();
 }
 
+ChainSettings SimpleEQAudioProcessor::getSmoothedSettings() const
+{
+    auto settings = currentSettings;
+    settings.lowCutFreq = smoothedLowCutFreq.getCurrentValue();
+    settings.highCutFreq = smoothedHighCutFreq.getCurrentValue();
+    settings.peakFreq = smoothedPeakFreq.getCurrentValue();
+    settings.peakGainInDecibels = smoothedPeakGain.getCurrentValue();
+    settings.peakQuality = smoothedPeakQuality.getCurrentValue();
+    return settings;
+}
 
+bool SimpleEQAudioProcessor::isSmoothing() const
+{
+    return smoothedLowCutFreq.isSmoothing()
+        || smoothedHighCutFreq.isSmoothing()
+        || smoothedPeakFreq.isSmoothing()
+        || smoothedPeakGain.isSmoothing()
+        || smoothedPeakQuality.isSmoothing();
+}
+
+void SimpleEQAudioProcessor::resetSmoothing(double sampleRate)
+{
+    currentSettings = getChainSettings(apvts);
+
+    smoothedLowCutFreq.reset(sampleRate, smoothingRampSeconds);
+    smoothedHighCutFreq.reset(sampleRate, smoothingRampSeconds);
+    smoothedPeakFreq.reset(sampleRate, smoothingRampSeconds);
+    smoothedPeakGain.reset(sampleRate, smoothingRampSeconds);
+    smoothedPeakQuality.reset(sampleRate, smoothingRampSeconds);
+
+    smoothedLowCutFreq.setCurrentAndTargetValue(currentSettings.lowCutFreq);
+    smoothedHighCutFreq.setCurrentAndTargetValue(currentSettings.highCutFreq);
+    smoothedPeakFreq.setCurrentAndTargetValue(currentSettings.peakFreq);
+    smoothedPeakGain.setCurrentAndTargetValue(currentSettings.peakGainInDecibels);
+    smoothedPeakQuality.setCurrentAndTargetValue(currentSettings.peakQuality);
+
+    samplesUntilCoefficientUpdate = 0;
+}
+
+void SimpleEQAudioProcessor::advanceSmoothing(int numSamples)
+{
+    const bool lowCutMoving = smoothedLowCutFreq.isSmoothing();
+    const bool peakMoving = smoothedPeakFreq.isSmoothing() || smoothedPeakGain.isSmoothing() || smoothedPeakQuality.isSmoothing();
+    const bool highCutMoving = smoothedHighCutFreq.isSmoothing();
+
+    smoothedLowCutFreq.skip(numSamples);
+    smoothedHighCutFreq.skip(numSamples);
+    smoothedPeakFreq.skip(numSamples);
+    smoothedPeakGain.skip(numSamples);
+    smoothedPeakQuality.skip(numSamples);
+
+    auto chainSettings = getSmoothedSettings();
+
+    if (lowCutMoving)
+        updateLowCutFilters(chainSettings);
+    if (peakMoving)
+        updatePeakFilter(chainSettings);
+    if (highCutMoving)
+        updateHighCutFilters(chainSettings);
+
+    rebuildCascade();
+}
+
+void SimpleEQAudioProcessor::markIIRFiltersDirty()
+{
+    lowCutDirty = true;
+    peakDirty = true;
+    highCutDirty = true;
+}
+
+void SimpleEQAudioProcessor::markAllFiltersDirty()
+{
+    markIIRFiltersDirty();
+    linearPhaseEQ.markDirty();
+}
+
+void SimpleEQAudioProcessor::parameterChanged(const juce::String& parameterID, float newValue)
+{
+    juce::ignoreUnused(newValue);
+
+    if (parameterID.startsWith("LowCut"))
+        lowCutDirty = true;
+    else if (parameterID.startsWith("Peak"))
+        peakDirty = true;
+    else if (parameterID.startsWith("HighCut"))
+        highCutDirty = true;
+    else
+        return;
+
+    linearPhaseEQ.markDirty();
+}
 
 juce::AudioProcessorValueTreeState::ParameterLayout
     SimpleEQAudioProcessor::createParameterLayout() {
@@ -330,6 +857,42 @@ juce::AudioProcessorValueTreeState::ParameterLayout
     layout.add(std::make_unique<juce::AudioParameterBool>("HighCut Bypassed", "HighCut Bypassed", false));
     layout.add(std::make_unique<juce::AudioParameterBool>("Analyser Enabled", "Analyser Enabled", false));
 
+    juce::StringArray overlapChoices;
+    for (auto overlap : analyserOverlaps)
+        overlapChoices.add(juce::String(juce::roundToInt(overlap * 100.f)) + "%");
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Analyser Overlap", "Analyser Overlap", overlapChoices, 1));
+
+    juce::StringArray resolutionChoices;
+    for (auto order : analyserFFTOrders)
+        resolutionChoices.add(juce::String(1 << order));
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Analyser Resolution", "Analyser Resolution", resolutionChoices, 0));
+
+    // one name per analyserAveragingTimes entry
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Analyser Averaging", "Analyser Averaging", juce::StringArray { "Off", "Fast", "Medium", "Slow" }, 1));
+    layout.add(std::make_unique<juce::AudioParameterBool>("Analyser Peak Hold", "Analyser Peak Hold", false));
+
+    juce::StringArray peakDecayChoices;
+    for (auto rate : analyserPeakDecayRates)
+        peakDecayChoices.add(juce::String(juce::roundToInt(rate)) + " dB/s");
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Analyser Peak Decay", "Analyser Peak Decay", peakDecayChoices, 2));
+
+    layout.add(std::make_unique<juce::AudioParameterBool>("Analyser Max Hold", "Analyser Max Hold", false));
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Analyser Mode", "Analyser Mode", juce::StringArray { "Left/Right", "Mid/Side" }, 0));
+    layout.add(std::make_unique<juce::AudioParameterBool>("Analyser Correlation", "Analyser Correlation", false));
+    layout.add(std::make_unique<juce::AudioParameterBool>("Analyser Multi-Resolution", "Analyser Multi-Resolution", true));
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Analyser Display", "Analyser Display", juce::StringArray { "Lines", "Spectrogram" }, 0));
+
+    // where several bins share a pixel column: the loudest, or their average. in the order of BinReduction
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Analyser Bin Reduction", "Analyser Bin Reduction", juce::StringArray { "Max", "Average" }, 0));
+
+    // runs the filters at 2x / 4x the host rate, so the peak & cut shapes don't cramp near nyquist
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Oversampling", "Oversampling", juce::StringArray { "1x", "2x", "4x" }, 0));
+
+    // linear phase FIR instead of the IIR filters. bigger partitions cost less CPU but add latency.
+    // a new partition size is crossfaded in once its convolver has warmed up, about a FIR length later
+    layout.add(std::make_unique<juce::AudioParameterBool>("Linear Phase", "Linear Phase", false));
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Linear Phase Partition", "Linear Phase Partition", LinearPhaseEQ::getPartitionSizeChoices(), 1));
+
     return layout;
 }
 
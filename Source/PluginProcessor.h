@@ -3,6 +3,11 @@
 #include <juce_audio_processors/juce_audio_processors.h>
 #include <juce_dsp/juce_dsp.h>
 #include <array>
+#include <atomic>
+#include <vector>
+#include "FilterCascade.h"
+#include "CoefficientTables.h"
+#include "LinearPhaseEQ.h"
 
 template<typename T>
 struct Fifo
@@ -74,7 +79,72 @@ enum Channel
     Left // effectively 1
 };
 
-template<typename BlockType>
+/**
+ wait-free single producer / single consumer ring of samples. the producer copies whole blocks in,
+ the consumer reads them in place as (at most) two contiguous spans either side of the wrap, so
+ nothing is allocated or copied into an intermediate buffer between the two threads.
+ */
+template<typename SampleType>
+struct SampleRing
+{
+    // not thread safe, call while neither side is running
+    void prepare(int capacity)
+    {
+        buffer.assign((size_t) capacity, SampleType { 0 });
+        fifo.setTotalSize(capacity);
+        fifo.reset();
+    }
+
+    // producer. anything that doesn't fit is dropped rather than waiting for the reader
+    template<typename InputType>
+    int write(const InputType* data, int numSamples)
+    {
+        const auto scope = fifo.write(juce::jmin(numSamples, fifo.getFreeSpace()));
+
+        copy(data, scope.blockSize1, buffer.data() + scope.startIndex1);
+        copy(data + scope.blockSize1, scope.blockSize2, buffer.data() + scope.startIndex2);
+
+        return scope.blockSize1 + scope.blockSize2;
+    }
+
+    // consumer. calls consume(const SampleType* data, int numSamples) once or twice, in order,
+    // then frees what was read
+    template<typename Consumer>
+    int read(int numSamples, Consumer&& consume)
+    {
+        const auto scope = fifo.read(juce::jmin(numSamples, fifo.getNumReady()));
+
+        if (scope.blockSize1 > 0)
+            consume(buffer.data() + scope.startIndex1, scope.blockSize1);
+        if (scope.blockSize2 > 0)
+            consume(buffer.data() + scope.startIndex2, scope.blockSize2);
+
+        return scope.blockSize1 + scope.blockSize2;
+    }
+
+    int getNumReady() const { return fifo.getNumReady(); }
+
+private:
+    std::vector<SampleType> buffer;
+    juce::AbstractFifo fifo { 1 };
+
+    template<typename InputType>
+    static void copy(const InputType* source, int numSamples, SampleType* dest)
+    {
+        if constexpr (std::is_same_v<InputType, SampleType>)
+            std::copy(source, source + numSamples, dest);
+        else
+            std::transform(source, source + numSamples, dest, [] (InputType x) { return static_cast<SampleType>(x); });
+    }
+};
+
+/**
+ one channel of the processor's output, handed to the analyzer through a SampleRing.
+
+ the reader runs on the analyzer thread, so it goes through a ReadScope: prepare() waits for open
+ scopes before it rebuilds the ring, and a scope opened while prepare() runs finds nothing to read.
+ */
+template<typename SampleType>
 struct SingleChannelSampleFifo
 {
     SingleChannelSampleFifo(Channel ch) : channelToUse(ch)
@@ -82,60 +152,83 @@ struct SingleChannelSampleFifo
         prepared.set(false);
     }
 
-    void update(const BlockType& buffer)
+    // audio thread. the analyzer always works in float, whatever precision the audio runs at
+    template<typename BufferType>
+    void update(const BufferType& buffer)
     {
         jassert(prepared.get());
-        jassert(buffer.getNumChannels() > channelToUse );
-        auto* channelPtr = buffer.getReadPointer(channelToUse);
+        jassert(buffer.getNumChannels() > 0);
 
-        for( int i = 0; i < buffer.getNumSamples(); ++i )
-        {
-            pushNextSampleIntoFifo(channelPtr[i]);
-        }
+        // a mono layout feeds both analyzer channels from its only channel
+        auto* channelPtr = buffer.getReadPointer(juce::jmin(static_cast<int>(channelToUse), buffer.getNumChannels() - 1));
+
+        const auto numWritten = ring.write(channelPtr, buffer.getNumSamples());
+        if (numWritten < buffer.getNumSamples())
+            numDroppedSamples.fetch_add(buffer.getNumSamples() - numWritten, std::memory_order_relaxed);
     }
 
+    // message thread, while audio isn't running
     void prepare(int bufferSize)
     {
         prepared.set(false);
+
+        // a read in progress finishes on the old ring, one that starts from here on sees it unprepared
+        while (numReaders.load() > 0)
+            juce::Thread::yield();
+
         size.set(bufferSize);
 
-        bufferToFill.setSize(1,             //channel
-                             bufferSize,    //num samples
-                             false,         //keepExistingContent
-                             true,          //clear extra space
-                             true);         //avoid reallocating
-        audioBufferFifo.prepare(1, bufferSize);
-        fifoIndex = 0;
+        // room for as many blocks as the old buffer-per-block fifo held, and at least a few analyzer windows
+        ring.prepare(juce::jmax(bufferSize * capacityInBlocks, minCapacity));
+        numDroppedSamples = 0;
         prepared.set(true);
     }
     //==============================================================================
-    int getNumCompleteBuffersAvailable() const { return audioBufferFifo.getNumAvailableForReading(); }
     bool isPrepared() const { return prepared.get(); }
     int getSize() const { return size.get(); }
     //==============================================================================
-    bool getAudioBuffer(BlockType& buf) { return audioBufferFifo.pull(buf); }
-private:
-    Channel channelToUse;
-    int fifoIndex = 0;
-    Fifo<BlockType> audioBufferFifo;
-    BlockType bufferToFill;
-    juce::Atomic<bool> prepared = false;
-    juce::Atomic<int> size = 0;
-
-    void pushNextSampleIntoFifo(float sample)
+    // the reader's access to the ring. only valid while the ring is prepared, and it stays
+    // prepared for as long as the scope exists
+    struct ReadScope
     {
-        if (fifoIndex == bufferToFill.getNumSamples())
+        explicit ReadScope(SingleChannelSampleFifo& fifoToRead) : fifo(fifoToRead)
         {
-            auto ok = audioBufferFifo.push(bufferToFill);
+            ++fifo.numReaders;
+            valid = fifo.prepared.get();
+        }
 
-            juce::ignoreUnused(ok);
+        ~ReadScope() { --fifo.numReaders; }
 
-            fifoIndex = 0;
+        bool isValid() const { return valid; }
+
+        int getNumSamplesAvailable() const { return valid ? fifo.ring.getNumReady() : 0; }
+
+        // see SampleRing::read
+        template<typename Consumer>
+        int read(int numSamples, Consumer&& consume)
+        {
+            return valid ? fifo.ring.read(numSamples, std::forward<Consumer>(consume)) : 0;
         }
 
-        bufferToFill.setSample(0, fifoIndex, sample);
-        ++fifoIndex;
-    }
+        // samples the ring had no room for since the last call
+        int takeNumDroppedSamples() { return fifo.numDroppedSamples.exchange(0, std::memory_order_relaxed); }
+
+    private:
+        SingleChannelSampleFifo& fifo;
+        bool valid = false;
+
+        JUCE_DECLARE_NON_COPYABLE(ReadScope)
+    };
+private:
+    static constexpr int capacityInBlocks = 30;
+    static constexpr int minCapacity = 1 << 15;
+
+    Channel channelToUse;
+    SampleRing<SampleType> ring;
+    juce::Atomic<bool> prepared = false;
+    juce::Atomic<int> size = 0;
+    std::atomic<int> numDroppedSamples { 0 };
+    std::atomic<int> numReaders { 0 };
 };
 
 enum Slope
@@ -159,12 +252,19 @@ struct ChainSettings
 // give parameter values in data struct
 ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts);
 
-using Filter = juce::dsp::IIR::Filter<float>; // Filter alias
+// choices of the "Analyser Overlap" parameter. a new analyzer frame is due every fftSize * (1 - overlap) samples
+constexpr std::array<float, 3> analyserOverlaps { 0.f, 0.5f, 0.75f };
+
+// choices of the "Analyser Resolution" parameter, as FFT orders
+constexpr std::array<int, 3> analyserFFTOrders { 11, 12, 13 };
 
-using CutFilter = juce::dsp::ProcessorChain<Filter, Filter, Filter, Filter>; // define a chain and pass in processing context that will run through each element of the chain
+// choices of the "Analyser Averaging" parameter, as the time constant of the averaging in seconds
+constexpr std::array<float, 4> analyserAveragingTimes { 0.f, 0.1f, 0.3f, 1.f };
 
-using MonoChain = juce::dsp::ProcessorChain<CutFilter, Filter, CutFilter>; // whole mono signal path
+// choices of the "Analyser Peak Decay" parameter, how fast the peak hold trace falls back in dB per second
+constexpr std::array<float, 5> analyserPeakDecayRates { 6.f, 12.f, 20.f, 40.f, 80.f };
 
+// the three bands in processing order, as an index into per-band data
 enum ChainPositions
 {
     LowCut,
@@ -172,63 +272,28 @@ enum ChainPositions
     HighCut,
 };
 
-using Coefficients = Filter::CoefficientsPtr;
-void updateCoefficients(Coefficients& old, const Coefficients& replacements);
+// a cut filter is a cascade of butterworth sections, one per 12 dB/Oct
+using CutCoefficients = std::array<BiquadCoefficients, maxCutSections>;
 
-Coefficients makePeakFilter(const ChainSettings& chainSettings, double sampleRate);
+inline int getNumCutSections(Slope slope) { return static_cast<int>(slope) + 1; }
 
-template<int Index, typename ChainType, typename CoefficientType>
-   void update(ChainType& chain, const CoefficientType& coefficients)
-{
-    if (coefficients[Index] !=nullptr)
-    {
-        updateCoefficients(chain.template get<Index>().coefficients, coefficients[Index]);
-        chain.template setBypassed<Index>(false);
-    }
-}
+// exact designs
+BiquadCoefficients makePeakFilter(const ChainSettings& chainSettings, double sampleRate);
+CutCoefficients makeLowCutFilter(const ChainSettings& chainSettings, double sampleRate);
+CutCoefficients makeHighCutFilter(const ChainSettings& chainSettings, double sampleRate);
 
-template<typename ChainType, typename CoefficientType>
-void updateCutFilter(ChainType& chain, const CoefficientType& coefficients, const Slope& slope)
-{
-    // bypass all links in the chain
-    chain.template setBypassed<0>(true);
-    chain.template setBypassed<1>(true);
-    chain.template setBypassed<2>(true);
-    chain.template setBypassed<3>(true);
+// every active section of the chain, exactly designed
+CascadeCoefficients<double> makeCascadeCoefficients(const ChainSettings& chainSettings, double sampleRate);
 
-    switch (slope)
-    {
-    case Slope_48:
-        {
-            update<3>(chain, coefficients);
-        }
-    case Slope_36:
-        {
-            update<2>(chain, coefficients);
-        }
-    case Slope_24:
-        {
-            update<1>(chain, coefficients);
-        }
-    case Slope_12:
-        {
-            update<0>(chain, coefficients);
-        }
-    }
-}
-
-inline auto makeLowCutFilter(const ChainSettings& chainSettings, double sampleRate)
-{
-    return juce::dsp::FilterDesign<float>::designIIRHighpassHighOrderButterworthMethod(chainSettings.lowCutFreq, sampleRate, 2 * (chainSettings.lowCutSlope + 1));
-}
-
-inline auto makeHighCutFilter(const ChainSettings& chainSettings, double sampleRate)
-{
-    return juce::dsp::FilterDesign<float>::designIIRLowpassHighOrderButterworthMethod(chainSettings.highCutFreq, sampleRate, 2 * (chainSettings.highCutSlope + 1));
-}
+// table driven designs, cheap enough to run on every smoothing step
+BiquadCoefficients makePeakFilter(const ChainSettings& chainSettings, const CoefficientTables& tables);
+CutCoefficients makeLowCutFilter(const ChainSettings& chainSettings, const CoefficientTables& tables);
+CutCoefficients makeHighCutFilter(const ChainSettings& chainSettings, const CoefficientTables& tables);
 
 //==============================================================================
-class SimpleEQAudioProcessor final : public juce::AudioProcessor
+class SimpleEQAudioProcessor final : public juce::AudioProcessor,
+                                     private juce::AudioProcessorValueTreeState::Listener,
+                                     private juce::AsyncUpdater
 {
 public:
     //==============================================================================
@@ -242,7 +307,10 @@ public:
     bool isBusesLayoutSupported (const BusesLayout& layouts) const override;
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
-    using AudioProcessor::processBlock;
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+
+    // the whole IIR path runs natively at either precision, so 64-bit hosts don't convert around us
+    bool supportsDoublePrecisionProcessing() const override { return true; }
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -270,20 +338,151 @@ public:
     static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
     juce::AudioProcessorValueTreeState apvts {*this, nullptr, "Parameters",  createParameterLayout()};
 
-    using BlockType = juce::AudioBuffer<float>;
-    SingleChannelSampleFifo<BlockType> leftChannelFifo { Channel::Left };
-    SingleChannelSampleFifo<BlockType> rightChannelFifo { Channel::Right };
+    SingleChannelSampleFifo<float> leftChannelFifo { Channel::Left };
+    SingleChannelSampleFifo<float> rightChannelFifo { Channel::Right };
+
+    // message thread: an editor drawing the analyzer registers here. the fifos are only fed while
+    // one is registered and "Analyser Enabled" is on, so instances without a UI don't pay for them
+    void addAnalyserConsumer() { ++numAnalyserConsumers; }
+    void removeAnalyserConsumer() { --numAnalyserConsumers; }
+
+    // any thread: the rate the filters are designed & run at with the current parameters. the
+    // oversampled rate, or the host's while the linear phase FIR (which isn't oversampled) is on
+    double getFilterSampleRate() const;
 
 private:
-    // two instances of the mono chain to do stereo processing
-    MonoChain leftChain, rightChain;
+    std::atomic<int> numAnalyserConsumers { 0 };
+    std::atomic<float>* analyserEnabledParam = nullptr;
+
+    // mono & stereo up to 7.1.4 / 16 channel stems and 3rd order ambisonics
+    static constexpr int maxChannels = 16;
+
+    // optional 2x / 4x oversampling around the filters, with polyphase IIR half-band stages
+    static constexpr int maxOversamplingOrder = 2;
+
+    /**
+     the filter path at one sample precision. both precisions share the band designs, but only
+     the one the host asked for in prepareToPlay gets its oversamplers & interleave buffer.
+     */
+    template<typename FloatType>
+    struct ProcessingState
+    {
+        // every channel shares the same coefficients, so channels run side by side in the lanes of one SIMD register
+        using BatchSample = juce::dsp::SIMDRegister<FloatType>;
+        static constexpr int maxChannelBatches = (maxChannels + (int) BatchSample::size() - 1) / (int) BatchSample::size();
+
+        // one cascade per batch of channels, each channel in its own SIMD lane
+        std::array<FilterCascade<BatchSample>, maxChannelBatches> batchCascades;
+        CascadeCoefficients<FloatType> cascadeCoefficients;
+
+        std::array<std::unique_ptr<juce::dsp::Oversampling<FloatType>>, maxOversamplingOrder> oversamplers;
+
+        juce::HeapBlock<char> interleavedData;
+        juce::dsp::AudioBlock<BatchSample> interleaved;
+
+        void prepare(size_t numChannels, size_t maxBlockSize);
+        void release();
+    };
+
+    ProcessingState<float> floatState;
+    ProcessingState<double> doubleState;
+
+    template<typename FloatType>
+    ProcessingState<FloatType>& getState()
+    {
+        if constexpr (std::is_same_v<FloatType, float>)
+            return floatState;
+        else
+            return doubleState;
+    }
+
+    // trig & gain lookups for the current processing rate, shared with other instances at the same rate
+    std::shared_ptr<const CoefficientTables> coefficientTables;
+
+    std::array<std::shared_ptr<const CoefficientTables>, maxOversamplingOrder + 1> oversampledTables;
+    std::atomic<float>* oversamplingParam = nullptr;
+    int oversamplingOrder = 0;
+    size_t maxBlockSize = 0, numPreparedChannels = 0;
+
+    int oversamplingLatency = 0;
+
+    void setOversamplingOrder(int newOrder);
+
+    // alternative to the IIR cascade: the same magnitude response as a linear phase FIR
+    LinearPhaseEQ linearPhaseEQ { apvts };
+    std::atomic<float>* linearPhaseParam = nullptr;
+    bool linearPhaseActive = false;
+
+    // the convolver works in float, the double path goes through here
+    juce::AudioBuffer<float> linearPhaseScratch;
+
+    template<typename FloatType>
+    void processLinearPhase(juce::dsp::AudioBlock<FloatType>& block);
+
+    // what the active mode delays the signal by
+    int getCurrentLatency() const;
+
+    // audio thread: a change is reported from the message thread, hosts may react to it synchronously
+    void updateLatency();
+    void handleAsyncUpdate() override;
+    std::atomic<int> pendingLatency { 0 };
+
+    // latest design of each band, flattened into both precisions' cascadeCoefficients whenever one of them changes
+    CutCoefficients lowCutCoefficients, highCutCoefficients;
+    BiquadCoefficients peakCoefficients;
+    int numLowCutSections = 0, numHighCutSections = 0;
+    bool peakActive = false;
+
+    // where each band section (low cut 0 - 3, peak, high cut 0 - 3) sits in the flattened cascade,
+    // -1 while it's left out. its filter state moves along with it when the others come & go
+    std::array<int, maxCascadeSections> cascadePositions;
+
+    void rebuildCascade();
+
+    void resetCascades();
+
+    template<typename FloatType>
+    void process(juce::AudioBuffer<FloatType>& buffer);
+
+    template<typename FloatType>
+    void processFilters(juce::dsp::AudioBlock<FloatType>& block);
+
+    template<typename FloatType>
+    void processChannelBatch(juce::dsp::AudioBlock<FloatType>& block, size_t firstChannel);
+
+    // frequencies, gain & Q glide to their targets. while any of them moves, the moving bands are
+    // redesigned every coefficientUpdateInterval samples, regardless of the host's block size
+    static constexpr double smoothingRampSeconds = 0.05;
+    static constexpr size_t coefficientUpdateInterval = 32;
+
+    using MultiplicativeSmoothedValue = juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative>;
+    MultiplicativeSmoothedValue smoothedLowCutFreq, smoothedHighCutFreq, smoothedPeakFreq, smoothedPeakQuality;
+    juce::SmoothedValue<float> smoothedPeakGain;
+
+    size_t samplesUntilCoefficientUpdate = 0;
+
+    // last parameter snapshot, the smoothed fields are replaced by the ramps' current values when designing
+    ChainSettings currentSettings;
+
+    ChainSettings getSmoothedSettings() const;
+    bool isSmoothing() const;
+    void resetSmoothing(double sampleRate);
+    void advanceSmoothing(int numSamples);
 
     void updatePeakFilter(const ChainSettings& chainSettings);
 
     void updateLowCutFilters(const ChainSettings& chainSettings);
     void updateHighCutFilters(const ChainSettings& chainSettings);
 
+    // only redesigns the bands whose parameters changed since the last call
     void updateFilters();
+    void markIIRFiltersDirty();
+    void markAllFiltersDirty();
+
+    // called from whichever thread changed the parameter, so it only flags the band
+    void parameterChanged(const juce::String& parameterID, float newValue) override;
+
+    juce::Atomic<bool> lowCutDirty {true}, peakDirty {true}, highCutDirty {true};
 
     juce::dsp::Oscillator<float> osc;
 
@@ -0,0 +1,405 @@
+#include "../../Source/PluginProcessor.h"
+#include <juce_audio_formats/juce_audio_formats.h>
+#include <juce_events/juce_events.h>
+#include <atomic>
+#include <iostream>
+#include <vector>
+
+/**
+ offline renderer for SimpleEQ: runs the plugin's own processor over WAV / AIFF files, with the
+ settings taken from a state blob (getStateInformation) or an XML preset of the same parameter tree.
+
+ every file is its own job on a thread pool. a job streams its file through one block-sized buffer,
+ so memory stays at (threads x channels x block size) however many or however long the files are.
+
+ the processors are created, prepared and destroyed on the main thread, the one with the message
+ manager, and only the processBlock loop runs on the pool. no more than one per pool thread exists at a time.
+ */
+
+namespace
+{
+struct Options
+{
+    juce::File stateFile, outputDirectory;
+    juce::Array<juce::File> inputFiles;
+    int numThreads = juce::SystemStats::getNumCpus();
+    int blockSize = 512;
+    bool doublePrecision = false;
+};
+
+void printUsage()
+{
+    std::cout << "usage: SimpleEQBatch --state <file> --output <dir> [options] <input files...>\n"
+                 "\n"
+                 "  --state <file>       plugin state saved by the plugin, or an XML preset of its parameters\n"
+                 "  --output <dir>       where the processed files go, named like their inputs\n"
+                 "  --threads <n>        files processed in parallel (default: number of cores)\n"
+                 "  --block-size <n>     samples per processBlock call (default: 512)\n"
+                 "  --double             process in double precision\n";
+}
+
+bool parseOptions(const juce::ArgumentList& args, Options& options)
+{
+    const juce::StringArray optionsWithValues { "--state", "--output", "--threads", "--block-size" };
+
+    for (int i = 0; i < args.size(); ++i)
+    {
+        const auto& arg = args[i];
+
+        if (arg.isLongOption())
+        {
+            // "--option value" rather than "--option=value", the value isn't an input file
+            if (optionsWithValues.contains(arg.text))
+                ++i;
+
+            continue;
+        }
+
+        options.inputFiles.add(arg.resolveAsFile());
+    }
+
+    options.stateFile = juce::File::getCurrentWorkingDirectory().getChildFile(args.getValueForOption("--state"));
+    options.outputDirectory = juce::File::getCurrentWorkingDirectory().getChildFile(args.getValueForOption("--output"));
+    options.doublePrecision = args.containsOption("--double");
+
+    if (args.containsOption("--threads"))
+        options.numThreads = juce::jmax(1, args.getValueForOption("--threads").getIntValue());
+
+    if (args.containsOption("--block-size"))
+        options.blockSize = juce::jlimit(16, 65536, args.getValueForOption("--block-size").getIntValue());
+
+    return args.containsOption("--state") && args.containsOption("--output") && ! options.inputFiles.isEmpty();
+}
+
+// accepts what getStateInformation writes, or the same tree as XML
+juce::MemoryBlock loadState(const juce::File& file)
+{
+    juce::MemoryBlock data;
+    if (! file.loadFileAsData(data))
+        return {};
+
+    if (juce::ValueTree::readFromData(data.getData(), data.getSize()).isValid())
+        return data;
+
+    if (auto xml = juce::parseXML(file))
+    {
+        const auto tree = juce::ValueTree::fromXml(*xml);
+        if (tree.isValid())
+        {
+            juce::MemoryBlock state;
+            juce::MemoryOutputStream mos(state, false);
+            tree.writeToStream(mos);
+            return state;
+        }
+    }
+
+    return {};
+}
+
+struct RenderResult
+{
+    bool ok = false;
+    juce::String error;
+    double audioSeconds = 0, renderSeconds = 0;
+};
+
+template<typename FloatType>
+void processChunk(SimpleEQAudioProcessor& processor, juce::AudioBuffer<float>& ioBuffer,
+                  juce::AudioBuffer<FloatType>& processBuffer, juce::MidiBuffer& midi)
+{
+    if constexpr (std::is_same_v<FloatType, float>)
+    {
+        juce::ignoreUnused(processBuffer);
+        processor.processBlock(ioBuffer, midi);
+    }
+    else
+    {
+        processBuffer.makeCopyOf(ioBuffer, true);
+        processor.processBlock(processBuffer, midi);
+        ioBuffer.makeCopyOf(processBuffer, true);
+    }
+}
+
+// one file: opened & prepared on the main thread, rendered on the pool, finished on the main thread
+struct Render
+{
+    juce::File input, output;
+    std::unique_ptr<juce::AudioFormatReader> reader;
+    std::unique_ptr<juce::AudioFormatWriter> writer;
+    std::unique_ptr<SimpleEQAudioProcessor> processor;
+    RenderResult result;
+    std::atomic<bool> finished { false };
+};
+
+// main thread. on failure the render has its error and no processor
+template<typename FloatType>
+void openRender(Render& render, juce::AudioFormatManager& formatManager,
+                const juce::MemoryBlock& state, int blockSize)
+{
+    auto& result = render.result;
+
+    if (render.output == render.input)
+    {
+        result = { false, "output would overwrite the input" };
+        return;
+    }
+
+    render.reader.reset(formatManager.createReaderFor(render.input));
+    if (render.reader == nullptr)
+    {
+        result = { false, "unreadable input" };
+        return;
+    }
+
+    auto* format = formatManager.findFormatForFileExtension(render.output.getFileExtension());
+    if (format == nullptr)
+    {
+        result = { false, "no writer for " + render.output.getFileExtension() };
+        return;
+    }
+
+    const auto numChannels = (int) render.reader->numChannels;
+    const auto sampleRate = render.reader->sampleRate;
+
+    auto processor = std::make_unique<SimpleEQAudioProcessor>();
+
+    juce::AudioProcessor::BusesLayout layout;
+    layout.inputBuses.add(juce::AudioChannelSet::canonicalChannelSet(numChannels));
+    layout.outputBuses.add(juce::AudioChannelSet::canonicalChannelSet(numChannels));
+    if (! processor->setBusesLayout(layout))
+    {
+        result = { false, "unsupported channel count " + juce::String(numChannels) };
+        return;
+    }
+
+    processor->setProcessingPrecision(std::is_same_v<FloatType, double> ? juce::AudioProcessor::doublePrecision
+                                                                        : juce::AudioProcessor::singlePrecision);
+    processor->setNonRealtime(true);
+    processor->setStateInformation(state.getData(), (int) state.getSize());
+
+    // like a host: the rate & block size are set before prepareToPlay, which relies on getSampleRate()
+    processor->setRateAndBufferSizeDetails(sampleRate, blockSize);
+    processor->prepareToPlay(sampleRate, blockSize);
+
+    render.output.deleteFile();
+    auto stream = render.output.createOutputStream();
+    if (stream == nullptr)
+    {
+        processor->releaseResources();
+        result = { false, "can't write " + render.output.getFullPathName() };
+        return;
+    }
+
+    render.writer.reset(format->createWriterFor(stream.get(), sampleRate,
+                                                (unsigned int) numChannels,
+                                                (int) render.reader->bitsPerSample,
+                                                render.reader->metadataValues, 0));
+    if (render.writer == nullptr)
+    {
+        processor->releaseResources();
+        result = { false, "can't create a writer for this format" };
+        return;
+    }
+
+    stream.release(); // the writer owns it now
+    render.processor = std::move(processor);
+}
+
+// a pool thread. only processBlock runs here: the processor's async callbacks would go to the main
+// thread, which doesn't dispatch them, so nothing in the render may wait for one
+template<typename FloatType>
+void runRender(Render& render, int blockSize)
+{
+    auto& result = render.result;
+    auto& processor = *render.processor;
+    auto& reader = render.reader;
+    auto& writer = render.writer;
+
+    const auto numChannels = (int) reader->numChannels;
+    const auto sampleRate = reader->sampleRate;
+    const auto length = reader->lengthInSamples;
+
+    juce::AudioBuffer<float> ioBuffer(numChannels, blockSize);
+    juce::AudioBuffer<FloatType> processBuffer(std::is_same_v<FloatType, float> ? 0 : numChannels,
+                                               std::is_same_v<FloatType, float> ? 0 : blockSize);
+    juce::MidiBuffer midi;
+
+    // the first 'latency' output samples are the plugin's delay, drop them & flush the same
+    // amount of silence through at the end so the output lines up with the input.
+    // prepareToPlay sets it directly, the async latency update is only for changes while audio runs
+    const auto latency = (juce::int64) processor.getLatencySamples();
+    auto samplesToSkip = latency;
+
+    const auto start = juce::Time::getMillisecondCounterHiRes();
+
+    for (juce::int64 position = 0; position < length + latency; position += blockSize)
+    {
+        const auto numSamples = (int) juce::jmin((juce::int64) blockSize, length + latency - position);
+
+        ioBuffer.setSize(numChannels, numSamples, false, false, true);
+        ioBuffer.clear();
+
+        if (position < length)
+            reader->read(ioBuffer.getArrayOfWritePointers(), numChannels, position,
+                         (int) juce::jmin((juce::int64) numSamples, length - position));
+
+        processBuffer.setSize(processBuffer.getNumChannels(), numSamples, false, false, true);
+        processChunk(processor, ioBuffer, processBuffer, midi);
+
+        const auto skip = (int) juce::jmin((juce::int64) numSamples, samplesToSkip);
+        samplesToSkip -= skip;
+
+        if (skip < numSamples && ! writer->writeFromAudioSampleBuffer(ioBuffer, skip, numSamples - skip))
+        {
+            result = { false, "write failed" };
+            return;
+        }
+    }
+
+    // flushes the file before the main thread reports it
+    writer.reset();
+
+    result.ok = true;
+    result.audioSeconds = double(length) / sampleRate;
+    result.renderSeconds = (juce::Time::getMillisecondCounterHiRes() - start) * 0.001;
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    // the processor's parameter state expects a message manager to exist
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    Options options;
+    if (! parseOptions(juce::ArgumentList(argc, argv), options))
+    {
+        printUsage();
+        return 1;
+    }
+
+    const auto state = loadState(options.stateFile);
+    if (state.isEmpty())
+    {
+        std::cerr << "couldn't read a SimpleEQ state from " << options.stateFile.getFullPathName() << "\n";
+        return 1;
+    }
+
+    if (! options.outputDirectory.createDirectory())
+    {
+        std::cerr << "couldn't create " << options.outputDirectory.getFullPathName() << "\n";
+        return 1;
+    }
+
+    // outputs are named like their inputs, two inputs of the same name would render into one file at once
+    {
+        juce::StringArray outputNames;
+
+        for (const auto& input : options.inputFiles)
+        {
+            if (outputNames.contains(input.getFileName(), ! juce::File::areFileNamesCaseSensitive()))
+            {
+                std::cerr << "more than one input is called " << input.getFileName() << ", their outputs would collide\n";
+                return 1;
+            }
+
+            outputNames.add(input.getFileName());
+        }
+    }
+
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    int numFailed = 0;
+    double totalAudioSeconds = 0;
+
+    // main thread only, like everything but the render loop itself
+    auto finishRender = [&](Render& render)
+    {
+        if (render.processor != nullptr)
+        {
+            render.processor->releaseResources();
+            render.processor.reset();
+        }
+
+        const auto& result = render.result;
+
+        if (result.ok)
+        {
+            totalAudioSeconds += result.audioSeconds;
+
+            std::cout << render.input.getFileName() << ": "
+                      << juce::String(result.audioSeconds / juce::jmax(result.renderSeconds, 1e-9), 1)
+                      << "x realtime (" << juce::String(result.audioSeconds, 1) << " s in "
+                      << juce::String(result.renderSeconds, 2) << " s)\n";
+        }
+        else
+        {
+            ++numFailed;
+            std::cerr << render.input.getFileName() << ": " << result.error << "\n";
+        }
+    };
+
+    const auto start = juce::Time::getMillisecondCounterHiRes();
+
+    {
+        juce::ThreadPool pool(options.numThreads);
+        std::vector<std::unique_ptr<Render>> running;
+        int nextInput = 0;
+
+        while (nextInput < options.inputFiles.size() || ! running.empty())
+        {
+            for (auto it = running.begin(); it != running.end();)
+            {
+                if ((*it)->finished.load())
+                {
+                    finishRender(**it);
+                    it = running.erase(it);
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+
+            // a prepared processor per busy pool thread, so memory doesn't grow with the number of files
+            while (nextInput < options.inputFiles.size() && (int) running.size() < options.numThreads)
+            {
+                auto render = std::make_unique<Render>();
+                render->input = options.inputFiles[nextInput++];
+                render->output = options.outputDirectory.getChildFile(render->input.getFileName());
+
+                if (options.doublePrecision)
+                    openRender<double>(*render, formatManager, state, options.blockSize);
+                else
+                    openRender<float>(*render, formatManager, state, options.blockSize);
+
+                if (render->processor == nullptr)
+                {
+                    finishRender(*render);
+                    continue;
+                }
+
+                pool.addJob([&options, r = render.get()]
+                {
+                    if (options.doublePrecision)
+                        runRender<double>(*r, options.blockSize);
+                    else
+                        runRender<float>(*r, options.blockSize);
+
+                    r->finished = true;
+                    return juce::ThreadPoolJob::jobHasFinished;
+                });
+
+                running.push_back(std::move(render));
+            }
+
+            juce::Thread::sleep(20);
+        }
+    }
+
+    const auto elapsed = (juce::Time::getMillisecondCounterHiRes() - start) * 0.001;
+    std::cout << options.inputFiles.size() - numFailed << " of " << options.inputFiles.size() << " files, "
+              << juce::String(totalAudioSeconds / juce::jmax(elapsed, 1e-9), 1) << "x realtime overall\n";
+
+    return numFailed == 0 ? 0 : 1;
+}